@@ -1,4 +1,17 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
 using namespace std;
 
 int factorial(int n)
@@ -15,6 +28,444 @@ int fibonacci(int n)
     return fibonacci(n - 1) + fibonacci(n - 2);
 }
 
+// Limb-level multiplication behind BigInt. Karatsuba splits each operand in
+// half and gets the product from three half-size products instead of four,
+// O(n^1.58) instead of O(n^2); below the threshold its extra additions cost
+// more than they save and schoolbook takes over.
+const size_t KARATSUBA_THRESHOLD = 32;
+
+// out[0, na + nb) = a * b
+void multiply_schoolbook(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out)
+{
+    fill(out, out + na + nb, 0u);
+    for (size_t i = 0; i < na; i++)
+    {
+        uint64_t carry = 0;
+        uint64_t digit = a[i];
+        for (size_t j = 0; j < nb; j++)
+        {
+            carry += digit * b[j] + out[i + j];
+            out[i + j] = uint32_t(carry);
+            carry >>= 32;
+        }
+        out[i + nb] = uint32_t(carry);
+    }
+}
+
+// out[offset, outSize) += src; the sum must fit in out
+void add_limbs_at(uint32_t *out, size_t outSize, size_t offset, const uint32_t *src, size_t srcSize)
+{
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < srcSize && offset + i < outSize; i++)
+    {
+        carry += uint64_t(out[offset + i]) + src[i];
+        out[offset + i] = uint32_t(carry);
+        carry >>= 32;
+    }
+    for (; carry && offset + i < outSize; i++)
+    {
+        carry += out[offset + i];
+        out[offset + i] = uint32_t(carry);
+        carry >>= 32;
+    }
+}
+
+// a[0, na) -= b[0, nb); requires a >= b
+void subtract_limbs(uint32_t *a, size_t na, const uint32_t *b, size_t nb)
+{
+    int64_t borrow = 0;
+    for (size_t i = 0; i < na && (i < nb || borrow); i++)
+    {
+        int64_t current = int64_t(a[i]) - (i < nb ? b[i] : 0) - borrow;
+        borrow = current < 0;
+        a[i] = uint32_t(current + (borrow << 32));
+    }
+}
+
+// out[0, na + nb) = a * b
+void multiply_limbs(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out)
+{
+    if (na < nb)
+    {
+        swap(a, b);
+        swap(na, nb);
+    }
+    if (nb < KARATSUBA_THRESHOLD)
+    {
+        multiply_schoolbook(a, na, b, nb, out);
+        return;
+    }
+    if (2 * nb <= na)
+    {
+        // Lopsided: multiply b by nb-limb slices of a and add them up
+        fill(out, out + na + nb, 0u);
+        vector<uint32_t> part(2 * nb);
+        for (size_t offset = 0; offset < na; offset += nb)
+        {
+            size_t length = min(nb, na - offset);
+            multiply_limbs(a + offset, length, b, nb, part.data());
+            add_limbs_at(out, na + nb, offset, part.data(), length + nb);
+        }
+        return;
+    }
+
+    // a = a1 B^m + a0, b = b1 B^m + b0 with B = 2^32; then
+    // a b = z2 B^2m + (z1 - z2 - z0) B^m + z0 for z1 = (a0 + a1)(b0 + b1)
+    size_t m = (na + 1) / 2;
+    multiply_limbs(a, m, b, m, out);                          // z0 into out[0, 2m)
+    multiply_limbs(a + m, na - m, b + m, nb - m, out + 2 * m); // z2 into out[2m, na + nb)
+
+    vector<uint32_t> aSum(a, a + m), bSum(b, b + m);
+    aSum.push_back(0);
+    bSum.push_back(0);
+    add_limbs_at(aSum.data(), m + 1, 0, a + m, na - m);
+    add_limbs_at(bSum.data(), m + 1, 0, b + m, nb - m);
+    vector<uint32_t> middle(2 * m + 2);
+    multiply_limbs(aSum.data(), m + 1, bSum.data(), m + 1, middle.data());
+    subtract_limbs(middle.data(), middle.size(), out, 2 * m);
+    subtract_limbs(middle.data(), middle.size(), out + 2 * m, na + nb - 2 * m);
+    add_limbs_at(out, na + nb, m, middle.data(), middle.size());
+}
+
+// Non-negative arbitrary-precision integer: little-endian 32-bit limbs with
+// no leading zero limbs, so zero is the empty vector. Products of two limbs
+// plus carries fit in 64 bits, which keeps every inner loop in plain integers.
+class BigInt
+{
+private:
+    vector<uint32_t> limbs;
+
+    void trim()
+    {
+        while (!limbs.empty() && limbs.back() == 0)
+            limbs.pop_back();
+    }
+
+public:
+    BigInt(uint64_t value = 0)
+    {
+        while (value)
+        {
+            limbs.push_back(uint32_t(value));
+            value >>= 32;
+        }
+    }
+
+    bool is_zero() const { return limbs.empty(); }
+    size_t limb_count() const { return limbs.size(); }
+
+    size_t bit_length() const
+    {
+        if (limbs.empty())
+            return 0;
+        size_t bits = 32 * (limbs.size() - 1);
+        for (uint32_t top = limbs.back(); top; top >>= 1)
+            bits++;
+        return bits;
+    }
+
+    // Remainder by a small divisor without building the quotient
+    uint32_t mod(uint32_t divisor) const
+    {
+        uint64_t remainder = 0;
+        for (size_t i = limbs.size(); i-- > 0;)
+            remainder = ((remainder << 32) | limbs[i]) % divisor;
+        return uint32_t(remainder);
+    }
+
+    // Decimal digits, peeled off nine at a time; quadratic, so meant for printing
+    string to_string() const
+    {
+        if (limbs.empty())
+            return "0";
+        vector<uint32_t> rest(limbs);
+        vector<uint32_t> chunks;
+        while (!rest.empty())
+        {
+            uint64_t remainder = 0;
+            for (size_t i = rest.size(); i-- > 0;)
+            {
+                uint64_t current = (remainder << 32) | rest[i];
+                rest[i] = uint32_t(current / 1000000000);
+                remainder = current % 1000000000;
+            }
+            chunks.push_back(uint32_t(remainder));
+            while (!rest.empty() && rest.back() == 0)
+                rest.pop_back();
+        }
+        string digits = std::to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;)
+        {
+            string chunk = std::to_string(chunks[i]);
+            digits += string(9 - chunk.size(), '0') + chunk;
+        }
+        return digits;
+    }
+
+    friend bool operator==(const BigInt &a, const BigInt &b) { return a.limbs == b.limbs; }
+    friend bool operator!=(const BigInt &a, const BigInt &b) { return a.limbs != b.limbs; }
+
+    friend BigInt operator+(const BigInt &a, const BigInt &b)
+    {
+        const vector<uint32_t> &longer = a.limbs.size() >= b.limbs.size() ? a.limbs : b.limbs;
+        const vector<uint32_t> &shorter = a.limbs.size() >= b.limbs.size() ? b.limbs : a.limbs;
+        BigInt sum;
+        sum.limbs.resize(longer.size() + 1);
+        uint64_t carry = 0;
+        for (size_t i = 0; i < longer.size(); i++)
+        {
+            carry += uint64_t(longer[i]) + (i < shorter.size() ? shorter[i] : 0);
+            sum.limbs[i] = uint32_t(carry);
+            carry >>= 32;
+        }
+        sum.limbs[longer.size()] = uint32_t(carry);
+        sum.trim();
+        return sum;
+    }
+
+    // Requires a >= b
+    friend BigInt operator-(const BigInt &a, const BigInt &b)
+    {
+        BigInt difference;
+        difference.limbs.resize(a.limbs.size());
+        int64_t borrow = 0;
+        for (size_t i = 0; i < a.limbs.size(); i++)
+        {
+            int64_t current = int64_t(a.limbs[i]) - (i < b.limbs.size() ? b.limbs[i] : 0) - borrow;
+            borrow = current < 0;
+            difference.limbs[i] = uint32_t(current + (borrow << 32));
+        }
+        difference.trim();
+        return difference;
+    }
+
+    friend BigInt operator*(const BigInt &a, const BigInt &b)
+    {
+        BigInt product;
+        if (a.is_zero() || b.is_zero())
+            return product;
+        product.limbs.resize(a.limbs.size() + b.limbs.size());
+        multiply_limbs(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size(), product.limbs.data());
+        product.trim();
+        return product;
+    }
+
+    BigInt &multiply_small(uint32_t factor)
+    {
+        uint64_t carry = 0;
+        for (uint32_t &limb : limbs)
+        {
+            carry += uint64_t(limb) * factor;
+            limb = uint32_t(carry);
+            carry >>= 32;
+        }
+        if (carry)
+            limbs.push_back(uint32_t(carry));
+        trim();
+        return *this;
+    }
+
+    BigInt &shift_left(size_t bits)
+    {
+        if (limbs.empty())
+            return *this;
+        size_t limbShift = bits / 32;
+        int bitShift = int(bits % 32);
+        limbs.push_back(0);
+        if (bitShift)
+        {
+            for (size_t i = limbs.size() - 1; i > 0; i--)
+                limbs[i] = (limbs[i] << bitShift) | (limbs[i - 1] >> (32 - bitShift));
+            limbs[0] <<= bitShift;
+        }
+        limbs.insert(limbs.begin(), limbShift, 0u);
+        trim();
+        return *this;
+    }
+
+    // Each cross product a[i] * a[j] appears twice in a square, so compute it
+    // once, double the sum with a shift and add the diagonal: about half the
+    // limb multiplications of a * a
+    BigInt square() const
+    {
+        BigInt result;
+        size_t n = limbs.size();
+        if (n == 0)
+            return result;
+        if (n >= KARATSUBA_THRESHOLD)
+            return *this * *this;
+        result.limbs.assign(2 * n, 0);
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t carry = 0;
+            uint64_t digit = limbs[i];
+            for (size_t j = i + 1; j < n; j++)
+            {
+                carry += digit * limbs[j] + result.limbs[i + j];
+                result.limbs[i + j] = uint32_t(carry);
+                carry >>= 32;
+            }
+            result.limbs[i + n] = uint32_t(carry);
+        }
+        uint32_t shiftedOut = 0;
+        for (uint32_t &limb : result.limbs)
+        {
+            uint32_t next = limb >> 31;
+            limb = (limb << 1) | shiftedOut;
+            shiftedOut = next;
+        }
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            carry += uint64_t(limbs[i]) * limbs[i] + result.limbs[2 * i];
+            result.limbs[2 * i] = uint32_t(carry);
+            carry >>= 32;
+            carry += result.limbs[2 * i + 1];
+            result.limbs[2 * i + 1] = uint32_t(carry);
+            carry >>= 32;
+        }
+        result.trim();
+        return result;
+    }
+
+    friend ostream &operator<<(ostream &out, const BigInt &value)
+    {
+        return out << value.to_string();
+    }
+};
+
+// fib(93) is the largest Fibonacci number that fits in 64 bits
+const int FIB_U64_MAX = 93;
+
+uint64_t fibonacci_u64(int n)
+{
+    uint64_t previous = 0, current = 1;
+    if (n == 0)
+        return 0;
+    for (int i = 1; i < n; i++)
+    {
+        uint64_t next = previous + current;
+        previous = current;
+        current = next;
+    }
+    return current;
+}
+
+// Fast doubling: from (F(k), F(k+1)),
+//   F(2k)   = F(k) * (2 F(k+1) - F(k))
+//   F(2k+1) = F(k)^2 + F(k+1)^2
+// so walking the bits of n from the top takes O(log n) big multiplications.
+// The numbers double in length each step, so the last step costs about as
+// much as all the others together; it only computes the one value returned.
+BigInt fibonacci_big(unsigned n)
+{
+    if (n <= FIB_U64_MAX)
+        return BigInt(fibonacci_u64(int(n)));
+    int top = 31;
+    while (!(n >> top))
+        top--;
+    BigInt a = 0, b = 1; // F(k), F(k+1) for k = the bits of n seen so far
+    for (int bit = top; bit > 0; bit--)
+    {
+        BigInt doubled = a * (b + b - a);
+        BigInt doubledPlusOne = a.square() + b.square();
+        if ((n >> bit) & 1)
+        {
+            a = doubledPlusOne;
+            b = doubled + doubledPlusOne;
+        }
+        else
+        {
+            a = doubled;
+            b = doubledPlusOne;
+        }
+    }
+    return n & 1 ? a.square() + b.square() : a * (b + b - a);
+}
+
+// Memoized Fibonacci for dense ranges of n: the table starts at first (seeded
+// by fast doubling) and grows one addition per entry as larger n are asked for
+class FibonacciTable
+{
+private:
+    unsigned first;
+    vector<BigInt> values;
+
+public:
+    explicit FibonacciTable(unsigned first = 0) : first(first)
+    {
+        values.push_back(fibonacci_big(first));
+        values.push_back(fibonacci_big(first + 1));
+    }
+
+    // n must be >= first; the reference stays valid until a larger n is requested
+    const BigInt &get(unsigned n)
+    {
+        while (values.size() <= n - first)
+            values.push_back(values[values.size() - 1] + values[values.size() - 2]);
+        return values[n - first];
+    }
+};
+
+// n! by binary splitting: multiply [lo, hi] as (lo .. mid) * (mid+1 .. hi), so
+// the big multiplications pair numbers of similar length (where Karatsuba
+// pays off) instead of growing one number by a small factor n times. The
+// factors of two are pulled out at the leaves and shifted back in at the end.
+// Independent halves near the top of the tree run on separate threads.
+const unsigned FACTORIAL_LEAF = 32;
+
+BigInt odd_product(unsigned lo, unsigned hi, size_t &twos, int parallelDepth)
+{
+    if (hi - lo < FACTORIAL_LEAF)
+    {
+        BigInt product = 1;
+        uint64_t packed = 1;
+        for (unsigned i = lo; i <= hi; i++)
+        {
+            unsigned odd = i;
+            while (!(odd & 1))
+            {
+                odd >>= 1;
+                twos++;
+            }
+            if (packed > UINT32_MAX / odd)
+            {
+                product.multiply_small(uint32_t(packed));
+                packed = 1;
+            }
+            packed *= odd;
+        }
+        return product.multiply_small(uint32_t(packed));
+    }
+    unsigned mid = lo + (hi - lo) / 2;
+    if (parallelDepth > 0)
+    {
+        size_t leftTwos = 0;
+        BigInt left;
+        thread worker([&]
+                      { left = odd_product(lo, mid, leftTwos, parallelDepth - 1); });
+        BigInt right = odd_product(mid + 1, hi, twos, parallelDepth - 1);
+        worker.join();
+        twos += leftTwos;
+        return left * right;
+    }
+    BigInt left = odd_product(lo, mid, twos, 0);
+    return left * odd_product(mid + 1, hi, twos, 0);
+}
+
+BigInt factorial_big(unsigned n, unsigned threads = thread::hardware_concurrency())
+{
+    if (n < 2)
+        return 1;
+    int parallelDepth = 0;
+    while ((2u << parallelDepth) <= threads)
+        parallelDepth++;
+    size_t twos = 0;
+    BigInt product = odd_product(2, n, twos, parallelDepth);
+    return product.shift_left(twos);
+}
+
 int sum(int n)
 {
     if (n <= 0)
@@ -36,10 +487,412 @@ int gcd(int a, int b)
     return gcd(b, a % b);
 }
 
-int main()
+// Modular products without a division: for a modulus below 2^32,
+// inverse = floor(2^64 / modulus) turns x mod m into a multiply-high, a
+// multiply and at most one correcting subtraction (Barrett reduction)
+struct BarrettModulus
 {
+    uint64_t modulus;
+    uint64_t inverse;
+
+    explicit BarrettModulus(uint32_t modulus) : modulus(modulus), inverse(~uint64_t(0) / modulus) {}
+
+    // x * y mod modulus, for x, y < modulus
+    uint64_t multiply(uint64_t x, uint64_t y) const
+    {
+        uint64_t product = x * y;
+        uint64_t quotient = uint64_t(((unsigned __int128)product * inverse) >> 64);
+        uint64_t remainder = product - quotient * modulus;
+        return remainder >= modulus ? remainder - modulus : remainder;
+    }
+};
+
+// Exponentiation by squaring: x^n = (x^2)^(n/2), times x when n is odd, so
+// O(log n) multiplications instead of power()'s n. Without a modulus the
+// result wraps modulo 2^64; with one below 2^32 products are reduced by
+// Barrett reduction, and larger moduli go through 128-bit remainders.
+uint64_t power_fast(uint64_t x, uint64_t n, uint64_t modulus = 0)
+{
+    uint64_t result = 1;
+    if (!modulus)
+    {
+        for (; n; n >>= 1, x *= x)
+            if (n & 1)
+                result *= x;
+        return result;
+    }
+    if (modulus <= UINT32_MAX)
+    {
+        BarrettModulus reducer(static_cast<uint32_t>(modulus));
+        x %= modulus;
+        result %= modulus;
+        for (; n; n >>= 1, x = reducer.multiply(x, x))
+            if (n & 1)
+                result = reducer.multiply(result, x);
+        return result;
+    }
+    x %= modulus;
+    for (; n; n >>= 1, x = uint64_t((unsigned __int128)x * x % modulus))
+        if (n & 1)
+            result = uint64_t((unsigned __int128)result * x % modulus);
+    return result;
+}
+
+// Stein's binary GCD: gcd(2a, 2b) = 2 gcd(a, b), gcd(a, 2b) = gcd(a, b) for
+// odd a, and gcd(a, b) = gcd(|a - b|, min(a, b)). Count-trailing-zeros strips
+// all the twos in one instruction and subtraction replaces gcd()'s division.
+// The loop has no data-dependent branch, and the trailing zeros of the next
+// value are counted from the difference while min and |a - b| are formed.
+uint64_t gcd_binary(uint64_t a, uint64_t b)
+{
+    if (a == 0)
+        return b;
+    if (b == 0)
+        return a;
+    int aZeros = __builtin_ctzll(a);
+    int bZeros = __builtin_ctzll(b);
+    int shift = min(aZeros, bZeros);
+    b >>= bZeros;
+    while (a)
+    {
+        a >>= aZeros;
+        uint64_t difference = b - a;
+        aZeros = __builtin_ctzll(difference | (uint64_t(1) << 63));
+        // |a - b| without a branch: negate the wrapped difference when a > b
+        uint64_t negate = -uint64_t(a > b);
+        b = min(a, b);
+        a = (difference ^ negate) - negate;
+    }
+    return b << shift;
+}
+
+// Batch versions over arrays of 32-bit values. The vector kernels run the
+// same loops on 8 lanes at once, each lane masked off once it is done; the
+// loop count is the largest any lane needs.
+typedef void (*PowerBatchFn)(const uint32_t *x, const uint32_t *n, uint32_t *out, size_t count);
+typedef void (*GcdBatchFn)(const uint32_t *a, const uint32_t *b, uint32_t *out, size_t count);
+
+void power_batch_scalar(const uint32_t *x, const uint32_t *n, uint32_t *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        out[i] = uint32_t(power_fast(x[i], n[i]));
+}
+
+void gcd_batch_scalar(const uint32_t *a, const uint32_t *b, uint32_t *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        out[i] = uint32_t(gcd_binary(a[i], b[i]));
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__((target("avx2"))) void power_batch_avx2(const uint32_t *x, const uint32_t *n, uint32_t *out, size_t count)
+{
+    const __m256i one = _mm256_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i base = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+        __m256i exponent = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(n + i));
+        __m256i result = one;
+        while (!_mm256_testz_si256(exponent, exponent))
+        {
+            __m256i odd = _mm256_cmpeq_epi32(_mm256_and_si256(exponent, one), one);
+            result = _mm256_blendv_epi8(result, _mm256_mullo_epi32(result, base), odd);
+            base = _mm256_mullo_epi32(base, base);
+            exponent = _mm256_srli_epi32(exponent, 1);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), result);
+    }
+    power_batch_scalar(x + i, n + i, out + i, count - i);
+}
+
+// No vector trailing-zero count before AVX-512: isolate the lowest set bit,
+// convert it to float (exact for a power of two) and read the exponent.
+// Zero lanes come out as a huge shift, which variable shifts turn into 0.
+__attribute__((target("avx2"))) inline __m256i avx2_ctz(__m256i v)
+{
+    __m256i lowest = _mm256_and_si256(v, _mm256_sub_epi32(_mm256_setzero_si256(), v));
+    __m256i bits = _mm256_castps_si256(_mm256_cvtepi32_ps(lowest));
+    __m256i exponent = _mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xff));
+    return _mm256_sub_epi32(exponent, _mm256_set1_epi32(127));
+}
+
+__attribute__((target("avx2"))) void gcd_batch_avx2(const uint32_t *a, const uint32_t *b, uint32_t *out, size_t count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i bothZero = _mm256_cmpeq_epi32(_mm256_or_si256(x, y), zero);
+        __m256i shift = avx2_ctz(_mm256_or_si256(x, y));
+        // gcd(0, y) = y: move y into x so x is the nonzero one
+        __m256i xZero = _mm256_cmpeq_epi32(x, zero);
+        x = _mm256_blendv_epi8(x, y, xZero);
+        y = _mm256_andnot_si256(xZero, y);
+        x = _mm256_srlv_epi32(x, avx2_ctz(x));
+        __m256i active = _mm256_cmpeq_epi32(_mm256_cmpeq_epi32(y, zero), zero);
+        while (!_mm256_testz_si256(active, active))
+        {
+            __m256i odd = _mm256_srlv_epi32(y, avx2_ctz(y));
+            __m256i low = _mm256_min_epu32(x, odd);
+            __m256i high = _mm256_max_epu32(x, odd);
+            x = _mm256_blendv_epi8(x, low, active);
+            y = _mm256_blendv_epi8(y, _mm256_sub_epi32(high, low), active);
+            active = _mm256_cmpeq_epi32(_mm256_cmpeq_epi32(y, zero), zero);
+        }
+        __m256i result = _mm256_andnot_si256(bothZero, _mm256_sllv_epi32(x, shift));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), result);
+    }
+    gcd_batch_scalar(a + i, b + i, out + i, count - i);
+}
+#endif
+
+struct NumberKernels
+{
+    PowerBatchFn power;
+    GcdBatchFn gcd;
+    const char *name;
+};
+
+// SSE2 has no per-lane variable shifts or 32-bit low multiply, so below AVX2 the batches stay scalar
+NumberKernels select_number_kernels()
+{
+#ifdef HAVE_X86_SIMD
+    if (__builtin_cpu_supports("avx2"))
+        return {power_batch_avx2, gcd_batch_avx2, "AVX2"};
+#endif
+    return {power_batch_scalar, gcd_batch_scalar, "scalar"};
+}
+
+const NumberKernels number_kernels = select_number_kernels();
+
+// out[i] = x[i]^n[i], modulo 2^32, or modulo modulus when it is nonzero
+void power_batch(const uint32_t *x, const uint32_t *n, uint32_t *out, size_t count, uint32_t modulus = 0)
+{
+    if (!modulus)
+    {
+        number_kernels.power(x, n, out, count);
+        return;
+    }
+    // One Barrett reducer for the whole batch
+    BarrettModulus reducer(modulus);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t base = x[i] % modulus, result = 1 % modulus;
+        for (uint32_t e = n[i]; e; e >>= 1, base = reducer.multiply(base, base))
+            if (e & 1)
+                result = reducer.multiply(result, base);
+        out[i] = uint32_t(result);
+    }
+}
+
+void gcd_batch(const uint32_t *a, const uint32_t *b, uint32_t *out, size_t count)
+{
+    number_kernels.gcd(a, b, out, count);
+}
+
+// Benchmarks: build with optimizations for meaningful numbers, e.g.
+//   g++ -std=c++17 -O2 -o 05-recursion 05-recursion.cpp && ./05-recursion --bench
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+void benchmarkFibonacci(unsigned n)
+{
+    cout << "=== Fibonacci ===" << endl;
+    auto start = chrono::steady_clock::now();
+    int naive = fibonacci(32);
+    double naiveMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    uint64_t fast = fibonacci_u64(32);
+    double fastMs = elapsedMs(start);
+    cout << "  fib(32): naive recursion " << naiveMs << " ms, 64-bit loop " << fastMs << " ms"
+         << (uint64_t(naive) == fast ? "" : " (MISMATCH)") << endl;
+
+    for (unsigned size = 1000; size <= n; size *= 10)
+    {
+        start = chrono::steady_clock::now();
+        BigInt value = fibonacci_big(size);
+        double ms = elapsedMs(start);
+        cout << "  fib(" << size << "): " << ms << " ms, " << value.bit_length()
+             << " bits, last 9 digits " << value.mod(1000000000) << endl;
+    }
+
+    // Every fib(i) for i in [base, base + 10000): one table against a fast-doubling
+    // call per i, timed on every 100th i and scaled up
+    const unsigned count = 10000;
+    unsigned base = min(n, 100000u);
+    start = chrono::steady_clock::now();
+    FibonacciTable table(base);
+    size_t tableBits = 0;
+    for (unsigned i = base; i < base + count; i++)
+        tableBits += table.get(i).bit_length();
+    double tableMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    int mismatches = 0;
+    for (unsigned i = base; i < base + count; i += 100)
+        mismatches += fibonacci_big(i) != table.get(i);
+    double directMs = elapsedMs(start) * 100;
+    cout << "  fib(" << base << " .. " << base + count - 1 << "): table " << tableMs
+         << " ms, fast doubling per n ~" << directMs << " ms (" << tableBits << " bits in all"
+         << (mismatches ? ", MISMATCH" : "") << ")" << endl;
+}
+
+// n! one factor at a time, the way factorial(int) does it, for comparison
+BigInt factorial_iterative(unsigned n)
+{
+    BigInt product = 1;
+    for (unsigned i = 2; i <= n; i++)
+        product.multiply_small(i);
+    return product;
+}
+
+void benchmarkFactorial(unsigned maxN)
+{
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    cout << "=== Factorial ===" << endl;
+    for (unsigned n = 10000; n <= maxN; n *= 10)
+    {
+        cout << "  " << n << "!:";
+        BigInt expected;
+        if (n <= 100000)
+        {
+            auto start = chrono::steady_clock::now();
+            expected = factorial_iterative(n);
+            cout << " one factor at a time " << elapsedMs(start) << " ms,";
+        }
+        auto start = chrono::steady_clock::now();
+        BigInt serial = factorial_big(n, 1);
+        cout << " binary splitting " << elapsedMs(start) << " ms,";
+        start = chrono::steady_clock::now();
+        BigInt parallel = factorial_big(n, threads);
+        cout << " on " << threads << " thread(s) " << elapsedMs(start) << " ms, "
+             << serial.bit_length() << " bits"
+             << ((!expected.is_zero() && expected != serial) || serial != parallel ? " (MISMATCH)" : "") << endl;
+    }
+}
+
+// 100M pairs run as repeated batches over one buffer so the benchmark does not need
+// gigabytes; the buffer is still far larger than the caches
+template <typename Run>
+double time_batches(size_t pairs, size_t batch, Run run)
+{
+    auto start = chrono::steady_clock::now();
+    for (size_t done = 0; done < pairs; done += batch)
+        run(min(batch, pairs - done));
+    return elapsedMs(start);
+}
+
+void benchmarkPowerGcd(size_t pairs)
+{
+    const size_t batch = min<size_t>(pairs, 1 << 22);
+    vector<uint32_t> a(batch), b(batch), out(batch), expected(batch);
+    mt19937_64 rng(7);
+    cout << "=== power and gcd on " << pairs << " pairs, " << number_kernels.name << " kernels (ms) ===" << endl;
+
+    // Small bases and exponents so the original int power() cannot overflow
+    for (size_t i = 0; i < batch; i++)
+    {
+        a[i] = uint32_t(rng() % 8);
+        b[i] = uint32_t(rng() % 11);
+    }
+    for (size_t i = 0; i < batch; i++)
+        expected[i] = uint32_t(power(int(a[i]), int(b[i])));
+    double recursiveMs = time_batches(pairs, batch, [&](size_t count)
+                                      { for (size_t i = 0; i < count; i++)
+                                            out[i] = uint32_t(power(int(a[i]), int(b[i]))); });
+    double fastMs = time_batches(pairs, batch, [&](size_t count)
+                                 { for (size_t i = 0; i < count; i++)
+                                       out[i] = uint32_t(power_fast(a[i], b[i])); });
+    bool ok = out == expected;
+    double batchMs = time_batches(pairs, batch, [&](size_t count)
+                                  { power_batch(a.data(), b.data(), out.data(), count); });
+    ok = ok && out == expected;
+    cout << "  power, exponents < 11: recursive " << recursiveMs << ", power_fast " << fastMs
+         << ", power_batch " << batchMs << (ok ? "" : " (MISMATCH)") << endl;
+
+    // Full 32-bit exponents, where the recursion would need billions of calls
+    for (size_t i = 0; i < batch; i++)
+    {
+        a[i] = uint32_t(rng());
+        b[i] = uint32_t(rng());
+    }
+    const uint32_t prime = 1000000007;
+    for (size_t i = 0; i < batch; i++)
+        expected[i] = uint32_t(power_fast(a[i], b[i], prime));
+    fastMs = time_batches(pairs, batch, [&](size_t count)
+                          { for (size_t i = 0; i < count; i++)
+                                out[i] = uint32_t(power_fast(a[i], b[i], prime)); });
+    ok = out == expected;
+    batchMs = time_batches(pairs, batch, [&](size_t count)
+                           { power_batch(a.data(), b.data(), out.data(), count, prime); });
+    ok = ok && out == expected;
+    double wrapMs = time_batches(pairs, batch, [&](size_t count)
+                                 { power_batch(a.data(), b.data(), out.data(), count); });
+    cout << "  power mod 1e9+7, 32-bit exponents: power_fast " << fastMs << ", power_batch " << batchMs
+         << (ok ? "" : " (MISMATCH)") << "; mod 2^32 power_batch " << wrapMs << endl;
+
+    for (size_t i = 0; i < batch; i++)
+    {
+        a[i] = uint32_t(rng() >> 33);
+        b[i] = uint32_t(rng() >> 33);
+    }
+    for (size_t i = 0; i < batch; i++)
+        expected[i] = uint32_t(gcd(int(a[i]), int(b[i])));
+    recursiveMs = time_batches(pairs, batch, [&](size_t count)
+                               { for (size_t i = 0; i < count; i++)
+                                     out[i] = uint32_t(gcd(int(a[i]), int(b[i]))); });
+    ok = out == expected;
+    fastMs = time_batches(pairs, batch, [&](size_t count)
+                          { for (size_t i = 0; i < count; i++)
+                                out[i] = uint32_t(gcd_binary(a[i], b[i])); });
+    ok = ok && out == expected;
+    batchMs = time_batches(pairs, batch, [&](size_t count)
+                           { gcd_batch(a.data(), b.data(), out.data(), count); });
+    ok = ok && out == expected;
+    cout << "  gcd, 31-bit operands: recursive " << recursiveMs << ", gcd_binary " << fastMs
+         << ", gcd_batch " << batchMs << (ok ? "" : " (MISMATCH)") << endl;
+}
+
+// Usage: --bench [name] [n], where name is one of: all, fibonacci, factorial, powgcd
+int runBenchmarks(const string &which, int n)
+{
+    bool all = which == "all";
+    bool known = false;
+    if (all || which == "fibonacci")
+    {
+        benchmarkFibonacci(n ? unsigned(n) : 1000000);
+        known = true;
+    }
+    if (all || which == "factorial")
+    {
+        benchmarkFactorial(n ? unsigned(n) : 1000000);
+        known = true;
+    }
+    if (all || which == "powgcd")
+    {
+        benchmarkPowerGcd(n ? size_t(n) : 100000000);
+        known = true;
+    }
+    if (!known)
+    {
+        cout << "Unknown benchmark: " << which << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--bench")
+        return runBenchmarks(argc > 2 ? argv[2] : "all", argc > 3 ? atoi(argv[3]) : 0);
+
     cout << "Factorial of 5: " << factorial(5) << endl;
     cout << "Factorial of 7: " << factorial(7) << endl;
+    cout << "Factorial of 30 (big integer): " << factorial_big(30) << endl;
 
     cout << "First 10 Fibonacci numbers:" << endl;
     for (int i = 0; i < 10; i++)
@@ -47,10 +900,25 @@ int main()
         cout << fibonacci(i) << " ";
     }
     cout << endl;
+    cout << "fib(90) (64-bit): " << fibonacci_u64(90) << endl;
+    cout << "fib(300) (fast doubling): " << fibonacci_big(300) << endl;
+    FibonacciTable table(1000);
+    cout << "fib(1000) .. fib(1002) from a table: last 9 digits " << table.get(1000).mod(1000000000)
+         << ", " << table.get(1001).mod(1000000000) << ", " << table.get(1002).mod(1000000000) << endl;
 
     cout << "Sum 1 to 10: " << sum(10) << endl;
     cout << "2^8: " << power(2, 8) << endl;
     cout << "GCD(48, 18): " << gcd(48, 18) << endl;
+    cout << "3^200 mod 1000000007 (by squaring): " << power_fast(3, 200, 1000000007) << endl;
+    cout << "Binary GCD(48, 18): " << gcd_binary(48, 18) << endl;
+    uint32_t as[] = {48, 17, 0, 1024, 270, 99, 35, 121, 36};
+    uint32_t bs[] = {18, 5, 12, 96, 192, 0, 49, 44, 24};
+    uint32_t gcds[9];
+    gcd_batch(as, bs, gcds, 9);
+    cout << "Batch GCDs (" << number_kernels.name << "): ";
+    for (uint32_t g : gcds)
+        cout << g << " ";
+    cout << endl;
 
     return 0;
 }
\ No newline at end of file
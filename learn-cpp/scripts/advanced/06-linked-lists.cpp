@@ -1,4 +1,18 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
 using namespace std;
 
 struct Node
@@ -8,27 +22,100 @@ struct Node
     Node(int value) : data(value), next(nullptr) {}
 };
 
+// Plain per-node allocation: one new/delete for every element
+struct HeapNodeAllocator
+{
+    Node *allocate(int value) { return new Node(value); }
+    void deallocate(Node *node) { delete node; }
+
+    void clear(Node *head)
+    {
+        while (head)
+        {
+            Node *temp = head;
+            head = head->next;
+            delete temp;
+        }
+    }
+};
+
+// Slab allocator: hands out Nodes from contiguous chunks and recycles
+// removed ones through a free list threaded through their next pointers
+class NodePool
+{
+private:
+    static const size_t CHUNK_SIZE = 4096;
+
+    vector<Node *> chunks;
+    Node *freeList;
+    Node *cursor;
+    Node *chunkEnd;
+
+public:
+    NodePool() : freeList(nullptr), cursor(nullptr), chunkEnd(nullptr) {}
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    ~NodePool() { release(); }
+
+    Node *allocate(int value)
+    {
+        Node *slot;
+        if (freeList)
+        {
+            slot = freeList;
+            freeList = freeList->next;
+        }
+        else
+        {
+            if (cursor == chunkEnd)
+            {
+                cursor = static_cast<Node *>(::operator new(CHUNK_SIZE * sizeof(Node)));
+                chunkEnd = cursor + CHUNK_SIZE;
+                chunks.push_back(cursor);
+            }
+            slot = cursor++;
+        }
+        return new (slot) Node(value);
+    }
+
+    void deallocate(Node *node)
+    {
+        node->next = freeList;
+        freeList = node;
+    }
+
+    // Node is trivially destructible, so the list does not need to be walked
+    void clear(Node *) { release(); }
+
+    // Frees every chunk at once: O(chunks), not O(nodes)
+    void release()
+    {
+        for (Node *chunk : chunks)
+            ::operator delete(chunk);
+        chunks.clear();
+        freeList = cursor = chunkEnd = nullptr;
+    }
+};
+
+template <typename NodeAllocator = NodePool>
 class LinkedList
 {
 private:
     Node *head;
+    NodeAllocator allocator;
 
 public:
     LinkedList() : head(nullptr) {}
 
     ~LinkedList()
     {
-        while (head)
-        {
-            Node *temp = head;
-            head = head->next;
-            delete temp;
-        }
+        allocator.clear(head);
     }
 
     void insert(int value)
     {
-        Node *newNode = new Node(value);
+        Node *newNode = allocator.allocate(value);
         newNode->next = head;
         head = newNode;
     }
@@ -67,7 +154,7 @@ public:
         {
             Node *temp = head;
             head = head->next;
-            delete temp;
+            allocator.deallocate(temp);
             return;
         }
 
@@ -81,13 +168,780 @@ public:
         {
             Node *temp = current->next;
             current->next = current->next->next;
-            delete temp;
+            allocator.deallocate(temp);
+        }
+    }
+};
+
+// Unrolled linked list: each node is exactly one cache line holding 13 ints
+// plus the count and next pointer, so a scan touches one line per 13 values
+// instead of one node per value
+struct alignas(64) UnrolledNode
+{
+    static const int CAPACITY = 13;
+
+    int values[CAPACITY]; // oldest first; display walks it backwards
+    int count;
+    UnrolledNode *next;
+    UnrolledNode() : values(), count(0), next(nullptr) {}
+
+    // One bit per slot in use
+    unsigned liveMask() const
+    {
+        return (1u << count) - 1;
+    }
+};
+static_assert(sizeof(UnrolledNode) == 64, "UnrolledNode must fill exactly one cache line");
+
+// Compares value against the ints of a node and returns one bit per matching
+// slot. The SIMD kernels compare the whole 64-byte line, so bits above
+// CAPACITY (count and next) are garbage; callers mask with liveMask().
+unsigned blockMatchScalar(const int *block, int value)
+{
+    unsigned mask = 0;
+    for (int i = 0; i < UnrolledNode::CAPACITY; i++)
+        mask |= unsigned(block[i] == value) << i;
+    return mask;
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__((target("sse2"))) unsigned blockMatchSSE2(const int *block, int value)
+{
+    __m128i needle = _mm_set1_epi32(value);
+    unsigned mask = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        __m128i lane = _mm_load_si128(reinterpret_cast<const __m128i *>(block) + i);
+        __m128i eq = _mm_cmpeq_epi32(lane, needle);
+        mask |= unsigned(_mm_movemask_ps(_mm_castsi128_ps(eq))) << (4 * i);
+    }
+    return mask;
+}
+
+__attribute__((target("avx2"))) unsigned blockMatchAVX2(const int *block, int value)
+{
+    __m256i needle = _mm256_set1_epi32(value);
+    __m256i lo = _mm256_load_si256(reinterpret_cast<const __m256i *>(block));
+    __m256i hi = _mm256_load_si256(reinterpret_cast<const __m256i *>(block) + 1);
+    unsigned loMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(lo, needle)));
+    unsigned hiMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(hi, needle)));
+    return loMask | (hiMask << 8);
+}
+#endif
+
+// Walks the blocks from node and returns the first one holding value, with
+// its predecessor in *prev and the matching slots in *mask. The kernel is a
+// template argument so that it is inlined into the loop; one whole scan per
+// instruction set is picked at runtime instead of one call per block.
+typedef UnrolledNode *(*BlockScanFn)(UnrolledNode *node, int value, UnrolledNode **prev, unsigned *mask);
+
+template <unsigned (*Match)(const int *, int)>
+__attribute__((always_inline)) inline UnrolledNode *scanBlocks(UnrolledNode *node, int value,
+                                                               UnrolledNode **prev, unsigned *mask)
+{
+    UnrolledNode *before = nullptr;
+    for (; node; before = node, node = node->next)
+    {
+        unsigned found = Match(node->values, value) & node->liveMask();
+        if (found)
+        {
+            *prev = before;
+            *mask = found;
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+UnrolledNode *scanBlocksScalar(UnrolledNode *node, int value, UnrolledNode **prev, unsigned *mask)
+{
+    return scanBlocks<blockMatchScalar>(node, value, prev, mask);
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__((target("sse2"))) UnrolledNode *scanBlocksSSE2(UnrolledNode *node, int value,
+                                                             UnrolledNode **prev, unsigned *mask)
+{
+    return scanBlocks<blockMatchSSE2>(node, value, prev, mask);
+}
+
+__attribute__((target("avx2"))) UnrolledNode *scanBlocksAVX2(UnrolledNode *node, int value,
+                                                             UnrolledNode **prev, unsigned *mask)
+{
+    return scanBlocks<blockMatchAVX2>(node, value, prev, mask);
+}
+#endif
+
+BlockScanFn selectBlockScan()
+{
+#ifdef HAVE_X86_SIMD
+    if (__builtin_cpu_supports("avx2"))
+        return scanBlocksAVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return scanBlocksSSE2;
+#endif
+    return scanBlocksScalar;
+}
+
+const BlockScanFn blockScan = selectBlockScan();
+
+// Blocks come from contiguous chunks like NodePool's, handed out from the top
+// of each chunk down: new blocks go on the head, so a scan walks up through
+// memory one line at a time, which the hardware prefetcher follows. (A
+// separate new per block costs 192 bytes of heap for each 64-byte node.)
+class UnrolledLinkedList
+{
+private:
+    static const size_t CHUNK_BLOCKS = 1024;
+
+    UnrolledNode *head;
+    vector<UnrolledNode *> chunks;
+    UnrolledNode *freeBlocks;
+    UnrolledNode *chunkBegin;
+    UnrolledNode *cursor;
+
+    UnrolledNode *allocateBlock()
+    {
+        UnrolledNode *block;
+        if (freeBlocks)
+        {
+            block = freeBlocks;
+            freeBlocks = freeBlocks->next;
+        }
+        else
+        {
+            if (cursor == chunkBegin)
+            {
+                chunkBegin = new UnrolledNode[CHUNK_BLOCKS];
+                cursor = chunkBegin + CHUNK_BLOCKS;
+                chunks.push_back(chunkBegin);
+            }
+            block = --cursor;
+        }
+        *block = UnrolledNode();
+        return block;
+    }
+
+    void deallocateBlock(UnrolledNode *block)
+    {
+        block->next = freeBlocks;
+        freeBlocks = block;
+    }
+
+public:
+    UnrolledLinkedList() : head(nullptr), freeBlocks(nullptr), chunkBegin(nullptr), cursor(nullptr) {}
+    UnrolledLinkedList(const UnrolledLinkedList &) = delete;
+    UnrolledLinkedList &operator=(const UnrolledLinkedList &) = delete;
+
+    ~UnrolledLinkedList()
+    {
+        for (UnrolledNode *chunk : chunks)
+            delete[] chunk;
+    }
+
+    void insert(int value)
+    {
+        if (!head || head->count == UnrolledNode::CAPACITY)
+        {
+            UnrolledNode *newNode = allocateBlock();
+            newNode->next = head;
+            head = newNode;
+        }
+        head->values[head->count++] = value;
+    }
+
+    void display()
+    {
+        for (UnrolledNode *current = head; current; current = current->next)
+        {
+            for (int i = current->count - 1; i >= 0; i--)
+                cout << current->values[i] << " -> ";
+        }
+        cout << "NULL" << endl;
+    }
+
+    bool search(int value)
+    {
+        UnrolledNode *prev;
+        unsigned mask;
+        return blockScan(head, value, &prev, &mask) != nullptr;
+    }
+
+    // Removes the most recently inserted occurrence, like LinkedList::remove
+    void remove(int value)
+    {
+        UnrolledNode *prev = nullptr;
+        unsigned mask = 0;
+        UnrolledNode *current = blockScan(head, value, &prev, &mask);
+        if (!current)
+            return;
+
+        int slot = 31 - __builtin_clz(mask);
+        for (int i = slot; i < current->count - 1; i++)
+            current->values[i] = current->values[i + 1];
+        current->count--;
+
+        // Fold this block into its older neighbour whenever both fit in one, so scans stay dense
+        UnrolledNode *older = current->next;
+        if (older && current->count + older->count <= UnrolledNode::CAPACITY)
+        {
+            for (int i = 0; i < current->count; i++)
+                older->values[older->count++] = current->values[i];
+            current->count = 0;
+        }
+
+        if (current->count == 0)
+        {
+            if (prev)
+                prev->next = current->next;
+            else
+                head = current->next;
+            deallocateBlock(current);
+        }
+    }
+};
+
+// Epoch-based reclamation: a node unlinked from a lock-free structure is
+// only freed once every thread that might still be reading it has left its
+// critical section. Retired nodes are tagged with the global epoch and freed
+// after the epoch has advanced twice.
+class EpochDomain
+{
+public:
+    static const int MAX_THREADS = 256;
+
+    static EpochDomain &instance()
+    {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // RAII critical section; hold one while dereferencing shared nodes
+    class Guard
+    {
+    public:
+        Guard() : slot(EpochDomain::instance().enter()) {}
+        ~Guard() { EpochDomain::instance().exit(slot); }
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+    private:
+        int slot;
+    };
+
+    void retire(void *ptr, void (*deleter)(void *))
+    {
+        ThreadSlot &slot = slots[mySlot()];
+        uint64_t epoch = globalEpoch.load();
+        vector<Retired> &bucket = slot.limbo[epoch % 3];
+        if (slot.limboEpoch[epoch % 3] != epoch)
+        {
+            // Anything left in this bucket is at least three epochs old
+            freeAll(bucket);
+            slot.limboEpoch[epoch % 3] = epoch;
+        }
+        bucket.push_back({ptr, deleter});
+
+        if (++slot.retireCount % 64 == 0)
+        {
+            tryAdvance();
+            collect(slot);
+        }
+    }
+
+private:
+    static const uint64_t QUIESCENT = 0;
+
+    struct Retired
+    {
+        void *ptr;
+        void (*deleter)(void *);
+    };
+
+    struct alignas(64) ThreadSlot
+    {
+        atomic<bool> inUse{false};
+        atomic<uint64_t> epoch{QUIESCENT};
+        int nesting = 0;
+        unsigned retireCount = 0;
+        vector<Retired> limbo[3];
+        uint64_t limboEpoch[3] = {0, 0, 0};
+    };
+
+    // Gives the slot back when its thread exits; leftover retired nodes stay
+    // in the slot and are freed by its next owner or by the domain destructor
+    struct SlotHandle
+    {
+        int index = -1;
+        ~SlotHandle()
+        {
+            if (index >= 0)
+                EpochDomain::instance().slots[index].inUse.store(false);
+        }
+    };
+
+    atomic<uint64_t> globalEpoch{1};
+    ThreadSlot slots[MAX_THREADS];
+
+    EpochDomain() = default;
+
+    ~EpochDomain()
+    {
+        for (ThreadSlot &slot : slots)
+            for (vector<Retired> &bucket : slot.limbo)
+                freeAll(bucket);
+    }
+
+    int mySlot()
+    {
+        static thread_local SlotHandle handle;
+        if (handle.index < 0)
+        {
+            for (int i = 0;; i = (i + 1) % MAX_THREADS)
+            {
+                bool expected = false;
+                if (slots[i].inUse.compare_exchange_strong(expected, true))
+                {
+                    handle.index = i;
+                    break;
+                }
+            }
+        }
+        return handle.index;
+    }
+
+    int enter()
+    {
+        int index = mySlot();
+        ThreadSlot &slot = slots[index];
+        if (slot.nesting++ == 0)
+            slot.epoch.store(globalEpoch.load());
+        return index;
+    }
+
+    void exit(int index)
+    {
+        ThreadSlot &slot = slots[index];
+        if (--slot.nesting == 0)
+            slot.epoch.store(QUIESCENT);
+    }
+
+    // The epoch may only move on once every active thread has observed it
+    void tryAdvance()
+    {
+        uint64_t epoch = globalEpoch.load();
+        for (ThreadSlot &slot : slots)
+        {
+            uint64_t observed = slot.epoch.load();
+            if (observed != QUIESCENT && observed != epoch)
+                return;
+        }
+        globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    void collect(ThreadSlot &slot)
+    {
+        uint64_t epoch = globalEpoch.load();
+        for (int i = 0; i < 3; i++)
+        {
+            if (slot.limboEpoch[i] + 2 <= epoch)
+                freeAll(slot.limbo[i]);
         }
     }
+
+    static void freeAll(vector<Retired> &bucket)
+    {
+        for (Retired &r : bucket)
+            r.deleter(r.ptr);
+        bucket.clear();
+    }
 };
 
-int main()
+// Lock-free sorted set (Harris, 2001). A node is deleted by first setting
+// the low bit of its next pointer (logical delete), then unlinking it with
+// a CAS on its predecessor. Unlinked nodes go to the EpochDomain.
+class LockFreeOrderedList
 {
+private:
+    struct LFNode
+    {
+        int key;
+        atomic<uintptr_t> next;
+        LFNode(int k, uintptr_t n) : key(k), next(n) {}
+    };
+
+    LFNode *head;
+    LFNode *tail;
+
+    static bool isMarked(uintptr_t p) { return p & 1; }
+    static uintptr_t toWord(LFNode *node) { return reinterpret_cast<uintptr_t>(node); }
+    static LFNode *toNode(uintptr_t p) { return reinterpret_cast<LFNode *>(p & ~uintptr_t(1)); }
+    static void deleteNode(void *node) { delete static_cast<LFNode *>(node); }
+
+    // Returns the first unmarked node with key >= value and its unmarked
+    // predecessor, unlinking any marked nodes found in between
+    LFNode *find(int value, LFNode *&left)
+    {
+        for (;;)
+        {
+            LFNode *leftNext = nullptr;
+            LFNode *current = head;
+            uintptr_t currentNext = head->next.load();
+            do
+            {
+                if (!isMarked(currentNext))
+                {
+                    left = current;
+                    leftNext = toNode(currentNext);
+                }
+                current = toNode(currentNext);
+                if (current == tail)
+                    break;
+                currentNext = current->next.load();
+            } while (isMarked(currentNext) || current->key < value);
+            LFNode *right = current;
+
+            if (leftNext != right)
+            {
+                uintptr_t expected = toWord(leftNext);
+                if (!left->next.compare_exchange_strong(expected, toWord(right)))
+                    continue;
+                for (LFNode *node = leftNext; node != right; node = toNode(node->next.load()))
+                    EpochDomain::instance().retire(node, deleteNode);
+            }
+
+            if (right == tail || !isMarked(right->next.load()))
+                return right;
+        }
+    }
+
+public:
+    LockFreeOrderedList()
+    {
+        tail = new LFNode(0, 0);
+        head = new LFNode(0, toWord(tail));
+    }
+    LockFreeOrderedList(const LockFreeOrderedList &) = delete;
+    LockFreeOrderedList &operator=(const LockFreeOrderedList &) = delete;
+
+    // Must not run concurrently with other operations
+    ~LockFreeOrderedList()
+    {
+        LFNode *current = head;
+        while (current != tail)
+        {
+            LFNode *next = toNode(current->next.load());
+            delete current;
+            current = next;
+        }
+        delete tail;
+    }
+
+    bool insert(int value)
+    {
+        EpochDomain::Guard guard;
+        LFNode *newNode = nullptr;
+        for (;;)
+        {
+            LFNode *left;
+            LFNode *right = find(value, left);
+            if (right != tail && right->key == value)
+            {
+                delete newNode;
+                return false;
+            }
+            if (!newNode)
+                newNode = new LFNode(value, 0);
+            newNode->next.store(toWord(right));
+            uintptr_t expected = toWord(right);
+            if (left->next.compare_exchange_strong(expected, toWord(newNode)))
+                return true;
+        }
+    }
+
+    bool remove(int value)
+    {
+        EpochDomain::Guard guard;
+        LFNode *left;
+        LFNode *right;
+        uintptr_t rightNext;
+        for (;;)
+        {
+            right = find(value, left);
+            if (right == tail || right->key != value)
+                return false;
+            rightNext = right->next.load();
+            if (!isMarked(rightNext) &&
+                right->next.compare_exchange_strong(rightNext, rightNext | 1))
+                break;
+        }
+
+        uintptr_t expected = toWord(right);
+        if (left->next.compare_exchange_strong(expected, rightNext))
+            EpochDomain::instance().retire(right, deleteNode);
+        else
+            find(value, left); // someone else moved; let find unlink it
+        return true;
+    }
+
+    // Wait-free: walks past marked nodes without helping to unlink them
+    bool search(int value)
+    {
+        EpochDomain::Guard guard;
+        LFNode *current = toNode(head->next.load());
+        while (current != tail && current->key < value)
+            current = toNode(current->next.load());
+        return current != tail && current->key == value && !isMarked(current->next.load());
+    }
+
+    void display()
+    {
+        EpochDomain::Guard guard;
+        for (LFNode *current = toNode(head->next.load()); current != tail;
+             current = toNode(current->next.load()))
+        {
+            if (!isMarked(current->next.load()))
+                cout << current->key << " -> ";
+        }
+        cout << "NULL" << endl;
+    }
+};
+
+// Baseline for the concurrent benchmark: LinkedList behind one global mutex,
+// with the same set semantics as LockFreeOrderedList
+class MutexLinkedList
+{
+private:
+    mutex lock;
+    LinkedList<> list;
+
+public:
+    bool insert(int value)
+    {
+        lock_guard<mutex> guard(lock);
+        if (list.search(value))
+            return false;
+        list.insert(value);
+        return true;
+    }
+
+    bool remove(int value)
+    {
+        lock_guard<mutex> guard(lock);
+        if (!list.search(value))
+            return false;
+        list.remove(value);
+        return true;
+    }
+
+    bool search(int value)
+    {
+        lock_guard<mutex> guard(lock);
+        return list.search(value);
+    }
+};
+
+// Benchmark: build with optimizations for meaningful numbers, e.g.
+//   g++ -std=c++17 -O2 -o 06-linked-lists 06-linked-lists.cpp && ./06-linked-lists --bench 10000000
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template <typename NodeAllocator>
+void benchmarkAllocator(const string &name, int n)
+{
+    auto start = chrono::steady_clock::now();
+    LinkedList<NodeAllocator> *list = new LinkedList<NodeAllocator>();
+    for (int i = 0; i < n; i++)
+        list->insert(i);
+    double insertMs = elapsedMs(start);
+
+    // Pop half the list off the head and insert again so freed nodes get recycled
+    start = chrono::steady_clock::now();
+    for (int i = n - 1; i >= n - n / 2; i--)
+        list->remove(i);
+    for (int i = 0; i < n / 2; i++)
+        list->insert(i);
+    double churnMs = elapsedMs(start);
+
+    start = chrono::steady_clock::now();
+    delete list;
+    double destroyMs = elapsedMs(start);
+
+    cout << name << ": insert " << insertMs << " ms, remove+reinsert " << churnMs
+         << " ms, destroy " << destroyMs << " ms" << endl;
+}
+
+// Every probe misses, so each search walks the whole list
+template <typename List>
+void benchmarkSearch(const string &name, int n, int probes)
+{
+    List *list = new List();
+    for (int i = 0; i < n; i++)
+        list->insert(i);
+
+    auto start = chrono::steady_clock::now();
+    int found = 0;
+    for (int p = 0; p < probes; p++)
+        found += list->search(-1 - p);
+    double searchMs = elapsedMs(start);
+    delete list;
+
+    cout << name << ": " << probes << " full scans " << searchMs << " ms ("
+         << searchMs / probes << " ms/scan, " << found << " hits)" << endl;
+}
+
+uint32_t xorshift32(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// 80% search, 10% insert, 10% remove over a small shared key range
+template <typename ConcurrentList>
+double concurrentThroughput(int threadCount, int opsPerThread, int keyRange)
+{
+    ConcurrentList list;
+    for (int key = 0; key < keyRange; key += 2)
+        list.insert(key);
+
+    vector<thread> workers;
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < threadCount; t++)
+    {
+        workers.emplace_back([&list, t, opsPerThread, keyRange]()
+                             {
+            uint32_t state = 2463534242u + t;
+            for (int i = 0; i < opsPerThread; i++)
+            {
+                uint32_t r = xorshift32(state);
+                int key = r % keyRange;
+                uint32_t op = (r >> 16) % 10;
+                if (op == 0)
+                    list.insert(key);
+                else if (op == 1)
+                    list.remove(key);
+                else
+                    list.search(key);
+            } });
+    }
+    for (thread &worker : workers)
+        worker.join();
+    double seconds = elapsedMs(start) / 1000.0;
+    return threadCount * double(opsPerThread) / seconds / 1e6;
+}
+
+void runConcurrentBenchmark()
+{
+    const int opsPerThread = 200000;
+    const int keyRange = 1024;
+    int maxThreads = max(1u, thread::hardware_concurrency());
+
+    cout << "\n=== Concurrent set throughput (" << keyRange << " keys, Mops/s) ===" << endl;
+    vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    for (int threads : threadCounts)
+    {
+        cout << threads << " thread(s): mutex LinkedList "
+             << concurrentThroughput<MutexLinkedList>(threads, opsPerThread, keyRange)
+             << ", LockFreeOrderedList "
+             << concurrentThroughput<LockFreeOrderedList>(threads, opsPerThread, keyRange) << endl;
+    }
+}
+
+// Hammers one LockFreeOrderedList from several threads and checks that every
+// key ends up present exactly when its successful inserts outnumber its
+// successful removes, and that the list is still sorted
+bool runStressTest(int threadCount)
+{
+    const int keyRange = 512;
+    const int opsPerThread = 500000;
+    LockFreeOrderedList list;
+    vector<vector<int>> balance(threadCount, vector<int>(keyRange, 0));
+
+    vector<thread> workers;
+    for (int t = 0; t < threadCount; t++)
+    {
+        workers.emplace_back([&list, &balance, t]()
+                             {
+            uint32_t state = 88172645u + 7919u * t;
+            for (int i = 0; i < opsPerThread; i++)
+            {
+                uint32_t r = xorshift32(state);
+                int key = r % keyRange;
+                uint32_t op = (r >> 16) % 3;
+                if (op == 0)
+                    balance[t][key] += list.insert(key);
+                else if (op == 1)
+                    balance[t][key] -= list.remove(key);
+                else
+                    list.search(key);
+            } });
+    }
+    for (thread &worker : workers)
+        worker.join();
+
+    bool ok = true;
+    for (int key = 0; key < keyRange; key++)
+    {
+        int net = 0;
+        for (int t = 0; t < threadCount; t++)
+            net += balance[t][key];
+        if (net != int(list.search(key)))
+        {
+            cout << "Key " << key << ": net inserts " << net << " but search says "
+                 << list.search(key) << endl;
+            ok = false;
+        }
+    }
+
+    // Inserting every key once more must succeed exactly for the missing ones
+    int missing = 0;
+    for (int key = 0; key < keyRange; key++)
+        missing += !list.search(key);
+    int inserted = 0;
+    for (int key = keyRange - 1; key >= 0; key--)
+        inserted += list.insert(key);
+    if (inserted != missing)
+        ok = false;
+
+    cout << "Stress test with " << threadCount << " threads: " << (ok ? "PASSED" : "FAILED") << endl;
+    return ok;
+}
+
+void runBenchmarks(int n)
+{
+    cout << "=== Node allocation benchmark (" << n << " elements) ===" << endl;
+    benchmarkAllocator<HeapNodeAllocator>("new/delete per node", n);
+    benchmarkAllocator<NodePool>("NodePool           ", n);
+
+    cout << "\n=== Membership scan benchmark (" << n << " elements) ===" << endl;
+    benchmarkSearch<LinkedList<HeapNodeAllocator>>("LinkedList (heap nodes)", n, 20);
+    benchmarkSearch<LinkedList<NodePool>>("LinkedList (NodePool)  ", n, 20);
+    benchmarkSearch<UnrolledLinkedList>("UnrolledLinkedList     ", n, 20);
+
+    runConcurrentBenchmark();
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--bench")
+    {
+        runBenchmarks(argc > 2 ? atoi(argv[2]) : 10000000);
+        return 0;
+    }
+    if (argc > 1 && string(argv[1]) == "--stress")
+    {
+        int threads = argc > 2 ? atoi(argv[2]) : max(4u, thread::hardware_concurrency());
+        return runStressTest(threads) ? 0 : 1;
+    }
+
     LinkedList list;
 
     cout << "Inserting elements: 1, 2, 3, 4, 5" << endl;
@@ -109,5 +963,49 @@ int main()
     cout << "List contents after removal: ";
     list.display();
 
+    cout << "\n=== Unrolled linked list (" << UnrolledNode::CAPACITY << " ints per node) ===" << endl;
+    UnrolledLinkedList unrolled;
+    for (int i = 1; i <= 20; i++)
+        unrolled.insert(i);
+
+    cout << "List contents: ";
+    unrolled.display();
+
+    cout << "Searching for 3: " << (unrolled.search(3) ? "Found" : "Not found") << endl;
+    cout << "Searching for 21: " << (unrolled.search(21) ? "Found" : "Not found") << endl;
+
+    cout << "Removing elements 3 and 18" << endl;
+    unrolled.remove(3);
+    unrolled.remove(18);
+
+    cout << "List contents after removal: ";
+    unrolled.display();
+
+    cout << "\n=== Lock-free ordered list ===" << endl;
+    LockFreeOrderedList lockFree;
+    vector<thread> writers;
+    for (int t = 0; t < 4; t++)
+    {
+        // Four threads insert interleaved keys into the same list
+        writers.emplace_back([&lockFree, t]()
+                             {
+            for (int key = t; key < 20; key += 4)
+                lockFree.insert(key); });
+    }
+    for (thread &writer : writers)
+        writer.join();
+
+    cout << "List contents after 4 concurrent writers: ";
+    lockFree.display();
+
+    cout << "Searching for 7: " << (lockFree.search(7) ? "Found" : "Not found") << endl;
+    cout << "Inserting 7 again: " << (lockFree.insert(7) ? "Inserted" : "Already present") << endl;
+
+    cout << "Removing element 7" << endl;
+    lockFree.remove(7);
+
+    cout << "List contents after removal: ";
+    lockFree.display();
+
     return 0;
 }
\ No newline at end of file
@@ -1,18 +1,44 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 using namespace std;
 
 struct Node
 {
     int value;
+    int size; // nodes in this subtree; fits in padding, so Node stays 24 bytes
     Node *left;
     Node *right;
-    Node(int v) : value(v), left(nullptr), right(nullptr) {}
+    Node(int v) : value(v), size(1), left(nullptr), right(nullptr) {}
 };
 
+int subtree_size(Node *root)
+{
+    return root ? root->size : 0;
+}
+
+void update_size(Node *root)
+{
+    root->size = 1 + subtree_size(root->left) + subtree_size(root->right);
+}
+
 Node *insert(Node *root, int value)
 {
     if (!root)
         return new Node(value);
+    root->size++;
     if (value < root->value)
         root->left = insert(root->left, value);
     else
@@ -83,6 +109,7 @@ Node *remove(Node *root, int value)
         root->value = temp->value;
         root->right = remove(root->right, temp->value);
     }
+    update_size(root);
     return root;
 }
 
@@ -95,33 +122,1555 @@ void destroy(Node *root)
     delete root;
 }
 
-int main()
+// Iterative versions of the BST operations. They use O(1) stack no matter
+// how degenerate the tree is, so a chain of millions of nodes is fine.
+Node *insert_iterative(Node *root, int value)
 {
-    int values[] = {4, 2, 6, 1, 3, 5, 7};
-    Node *root = nullptr;
+    // Walk the link that will hold the new node, counting it into every
+    // subtree on the way down
+    Node **link = &root;
+    while (*link)
+    {
+        (*link)->size++;
+        link = value < (*link)->value ? &(*link)->left : &(*link)->right;
+    }
+    *link = new Node(value);
+    return root;
+}
 
-    cout << "Inserting values: ";
-    for (int v : values)
+bool find_iterative(Node *root, int value)
+{
+    while (root)
     {
-        cout << v << " ";
-        root = insert(root, v);
+        if (root->value == value)
+            return true;
+        root = value < root->value ? root->left : root->right;
     }
-    cout << endl;
+    return false;
+}
 
-    cout << "Inorder traversal (sorted): ";
-    inorder_print(root);
-    cout << endl;
+Node *remove_iterative(Node *root, int value)
+{
+    Node **link = &root;
+    while (*link && (*link)->value != value)
+        link = value < (*link)->value ? &(*link)->left : &(*link)->right;
 
-    cout << "Finding value 5: " << (find(root, 5) ? "Found" : "Not found") << endl;
-    cout << "Finding value 8: " << (find(root, 8) ? "Found" : "Not found") << endl;
+    Node *target = *link;
+    if (!target)
+        return root;
 
-    cout << "Removing value 2" << endl;
-    root = remove(root, 2);
+    // The value is present, so every subtree on the path loses one node
+    for (Node *node = root; node != target; node = value < node->value ? node->left : node->right)
+        node->size--;
 
-    cout << "Inorder traversal after removal: ";
-    inorder_print(root);
-    cout << endl;
+    if (!target->left)
+        *link = target->right;
+    else if (!target->right)
+        *link = target->left;
+    else
+    {
+        // Node with two children: move the successor's value up, unlink the successor
+        target->size--;
+        Node **successorLink = &target->right;
+        while ((*successorLink)->left)
+        {
+            (*successorLink)->size--;
+            successorLink = &(*successorLink)->left;
+        }
+        Node *successor = *successorLink;
+        target->value = successor->value;
+        *successorLink = successor->right;
+        target = successor;
+    }
+    delete target;
+    return root;
+}
 
-    destroy(root);
+// Morris traversal: threads each node's in-order predecessor back to it
+// instead of keeping a stack, and removes the thread on the second visit
+template <typename Visit>
+void inorder_visit(Node *root, Visit visit)
+{
+    Node *current = root;
+    while (current)
+    {
+        if (!current->left)
+        {
+            visit(current->value);
+            current = current->right;
+            continue;
+        }
+
+        Node *predecessor = current->left;
+        while (predecessor->right && predecessor->right != current)
+            predecessor = predecessor->right;
+
+        if (!predecessor->right)
+        {
+            predecessor->right = current;
+            current = current->left;
+        }
+        else
+        {
+            predecessor->right = nullptr;
+            visit(current->value);
+            current = current->right;
+        }
+    }
+}
+
+void inorder_print_iterative(Node *root)
+{
+    inorder_visit(root, [](int value)
+                  { cout << value << ' '; });
+}
+
+// Rotates left children up until there are none, deleting as it goes: O(1) extra space
+void destroy_iterative(Node *root)
+{
+    while (root)
+    {
+        if (root->left)
+        {
+            Node *left = root->left;
+            root->left = left->right;
+            left->right = root;
+            root = left;
+        }
+        else
+        {
+            Node *right = root->right;
+            delete root;
+            root = right;
+        }
+    }
+}
+
+// Order statistics. Every node knows the size of its subtree, so each query
+// follows one root-to-leaf path: O(height) instead of an in-order walk.
+
+// Number of keys below value (or at most value when inclusive is set)
+int count_below(Node *root, int value, bool inclusive)
+{
+    int count = 0;
+    while (root)
+    {
+        if (value < root->value || (value == root->value && !inclusive))
+            root = root->left;
+        else
+        {
+            count += 1 + subtree_size(root->left);
+            root = root->right;
+        }
+    }
+    return count;
+}
+
+// How many keys are smaller than value (named to stay clear of std::rank)
+int rank_of(Node *root, int value)
+{
+    return count_below(root, value, false);
+}
+
+// The k-th smallest key, counting from 0, or nullptr when k is out of range
+Node *select(Node *root, int k)
+{
+    while (root)
+    {
+        int leftSize = subtree_size(root->left);
+        if (k < leftSize)
+            root = root->left;
+        else if (k == leftSize)
+            return root;
+        else
+        {
+            k -= leftSize + 1;
+            root = root->right;
+        }
+    }
+    return nullptr;
+}
+
+// How many keys lie in [lo, hi]
+int count_range(Node *root, int lo, int hi)
+{
+    if (lo > hi)
+        return 0;
+    return count_below(root, hi, true) - count_below(root, lo, false);
+}
+
+// AVL tree: the same operations, but every insert/remove rebalances with
+// rotations so the height stays O(log n) even for sorted input
+struct AvlNode
+{
+    int value;
+    int height;
+    AvlNode *left;
+    AvlNode *right;
+    AvlNode(int v) : value(v), height(1), left(nullptr), right(nullptr) {}
+};
+
+int height(AvlNode *node)
+{
+    return node ? node->height : 0;
+}
+
+void updateHeight(AvlNode *node)
+{
+    node->height = 1 + max(height(node->left), height(node->right));
+}
+
+AvlNode *rotateRight(AvlNode *root)
+{
+    AvlNode *pivot = root->left;
+    root->left = pivot->right;
+    pivot->right = root;
+    updateHeight(root);
+    updateHeight(pivot);
+    return pivot;
+}
+
+AvlNode *rotateLeft(AvlNode *root)
+{
+    AvlNode *pivot = root->right;
+    root->right = pivot->left;
+    pivot->left = root;
+    updateHeight(root);
+    updateHeight(pivot);
+    return pivot;
+}
+
+// Restores |height(left) - height(right)| <= 1 after one insert or remove below root
+AvlNode *rebalance(AvlNode *root)
+{
+    updateHeight(root);
+    int balance = height(root->left) - height(root->right);
+    if (balance > 1)
+    {
+        if (height(root->left->left) < height(root->left->right))
+            root->left = rotateLeft(root->left);
+        return rotateRight(root);
+    }
+    if (balance < -1)
+    {
+        if (height(root->right->right) < height(root->right->left))
+            root->right = rotateRight(root->right);
+        return rotateLeft(root);
+    }
+    return root;
+}
+
+AvlNode *insert(AvlNode *root, int value)
+{
+    if (!root)
+        return new AvlNode(value);
+    if (value < root->value)
+        root->left = insert(root->left, value);
+    else
+        root->right = insert(root->right, value);
+    return rebalance(root);
+}
+
+void inorder_print(AvlNode *root)
+{
+    if (!root)
+        return;
+    inorder_print(root->left);
+    cout << root->value << ' ';
+    inorder_print(root->right);
+}
+
+bool find(AvlNode *root, int value)
+{
+    while (root)
+    {
+        if (root->value == value)
+            return true;
+        root = value < root->value ? root->left : root->right;
+    }
+    return false;
+}
+
+AvlNode *findMin(AvlNode *root)
+{
+    if (!root)
+        return nullptr;
+    while (root->left)
+        root = root->left;
+    return root;
+}
+
+AvlNode *remove(AvlNode *root, int value)
+{
+    if (!root)
+        return root;
+
+    if (value < root->value)
+    {
+        root->left = remove(root->left, value);
+    }
+    else if (value > root->value)
+    {
+        root->right = remove(root->right, value);
+    }
+    else
+    {
+        // Node to be deleted found
+        if (!root->left)
+        {
+            AvlNode *temp = root->right;
+            delete root;
+            return temp;
+        }
+        else if (!root->right)
+        {
+            AvlNode *temp = root->left;
+            delete root;
+            return temp;
+        }
+
+        // Node with two children
+        AvlNode *temp = findMin(root->right);
+        root->value = temp->value;
+        root->right = remove(root->right, temp->value);
+    }
+    return rebalance(root);
+}
+
+void destroy(AvlNode *root)
+{
+    if (!root)
+        return;
+    destroy(root->left);
+    destroy(root->right);
+    delete root;
+}
+
+// BST whose nodes live in one growable pool and link by 32-bit index
+// instead of by pointer: 12 bytes per node and no per-node malloc header.
+// Slot 0 is a sentinel standing in for nullptr; removed slots are chained
+// through their left index and handed out again by insert.
+class IndexedTree
+{
+private:
+    struct Slot
+    {
+        int value;
+        uint32_t left;
+        uint32_t right;
+    };
+    static_assert(sizeof(Slot) == 12, "index nodes should pack into 12 bytes");
+
+    vector<Slot> nodes;
+    uint32_t root;
+    uint32_t freeList;
+    size_t live;
+
+    uint32_t allocate(int value)
+    {
+        uint32_t index;
+        if (freeList)
+        {
+            index = freeList;
+            freeList = nodes[index].left;
+            nodes[index] = {value, 0, 0};
+        }
+        else
+        {
+            index = uint32_t(nodes.size());
+            nodes.push_back({value, 0, 0});
+        }
+        live++;
+        return index;
+    }
+
+    void release(uint32_t index)
+    {
+        nodes[index].left = freeList;
+        freeList = index;
+        live--;
+    }
+
+public:
+    IndexedTree() : nodes(1, Slot{0, 0, 0}), root(0), freeList(0), live(0) {}
+
+    void reserve(size_t count) { nodes.reserve(count + 1); }
+    size_t size() const { return live; }
+
+    void insert(int value)
+    {
+        // Allocate first: growing the pool would invalidate the link pointer below
+        uint32_t index = allocate(value);
+        uint32_t *link = &root;
+        while (*link)
+            link = value < nodes[*link].value ? &nodes[*link].left : &nodes[*link].right;
+        *link = index;
+    }
+
+    bool find(int value) const
+    {
+        uint32_t current = root;
+        while (current)
+        {
+            if (nodes[current].value == value)
+                return true;
+            current = value < nodes[current].value ? nodes[current].left : nodes[current].right;
+        }
+        return false;
+    }
+
+    void remove(int value)
+    {
+        uint32_t *link = &root;
+        while (*link && nodes[*link].value != value)
+            link = value < nodes[*link].value ? &nodes[*link].left : &nodes[*link].right;
+
+        uint32_t target = *link;
+        if (!target)
+            return;
+
+        if (!nodes[target].left)
+            *link = nodes[target].right;
+        else if (!nodes[target].right)
+            *link = nodes[target].left;
+        else
+        {
+            // Node with two children: move the successor's value up, unlink the successor
+            uint32_t *successorLink = &nodes[target].right;
+            while (nodes[*successorLink].left)
+                successorLink = &nodes[*successorLink].left;
+            uint32_t successor = *successorLink;
+            nodes[target].value = nodes[successor].value;
+            *successorLink = nodes[successor].right;
+            target = successor;
+        }
+        release(target);
+    }
+
+    void inorder_print() const
+    {
+        vector<uint32_t> stack;
+        uint32_t current = root;
+        while (current || !stack.empty())
+        {
+            while (current)
+            {
+                stack.push_back(current);
+                current = nodes[current].left;
+            }
+            current = stack.back();
+            stack.pop_back();
+            cout << nodes[current].value << ' ';
+            current = nodes[current].right;
+        }
+    }
+
+    void memory_report() const
+    {
+        size_t used = nodes.size() * sizeof(Slot);
+        size_t reserved = nodes.capacity() * sizeof(Slot);
+        cout << "IndexedTree: " << live << " live nodes, " << nodes.size() - 1 - live
+             << " free slots, " << sizeof(Slot) << " bytes/node, " << used << " bytes used, "
+             << reserved << " bytes reserved (a pointer Node is " << sizeof(Node)
+             << " bytes plus its malloc header)" << endl;
+    }
+};
+
+// Immutable search index in Eytzinger (BFS) order: slot k has its children
+// in slots 2k and 2k+1, so the top levels share a few cache lines and the
+// 16 descendants four levels down sit in one 64-byte line we can prefetch
+class EytzingerIndex
+{
+private:
+    struct AlignedDelete
+    {
+        void operator()(int *p) const { ::operator delete(p, align_val_t(64)); }
+    };
+
+    unique_ptr<int[], AlignedDelete> slots; // 1-based; slots[0] is unused
+    size_t count;
+    int fullLevels; // levels in which every slot is filled
+
+    // Lays the sorted keys out by an in-order walk of the implicit tree
+    void fill(const vector<int> &sorted, size_t &next, size_t k)
+    {
+        if (k > count)
+            return;
+        fill(sorted, next, 2 * k);
+        slots[k] = sorted[next++];
+        fill(sorted, next, 2 * k + 1);
+    }
+
+    // After the descent, k encodes the path; dropping the trailing right turns
+    // and the final left turn leaves the slot of the first key >= value
+    static size_t lowerBoundSlot(size_t k)
+    {
+        return k >> __builtin_ffsll(~k);
+    }
+
+public:
+    explicit EytzingerIndex(const vector<int> &sorted)
+        : slots(static_cast<int *>(::operator new((sorted.size() + 1) * sizeof(int), align_val_t(64)))),
+          count(sorted.size()), fullLevels(0)
+    {
+        size_t next = 0;
+        fill(sorted, next, 1);
+        while ((size_t(2) << fullLevels) - 1 <= count)
+            fullLevels++;
+    }
+
+    size_t size() const { return count; }
+
+    bool find(int value) const
+    {
+        size_t k = 1;
+        while (k <= count)
+        {
+            __builtin_prefetch(slots.get() + k * 16);
+            k = 2 * k + (slots[k] < value);
+        }
+        k = lowerBoundSlot(k);
+        return k != 0 && slots[k] == value;
+    }
+
+    // Runs a group of lookups in lockstep, one level at a time, so their
+    // cache misses overlap instead of being paid one after another
+    void find_many(const int *values, size_t n, bool *found) const
+    {
+        const size_t GROUP = 16;
+        size_t k[GROUP];
+        for (size_t start = 0; start < n; start += GROUP)
+        {
+            size_t group = min(GROUP, n - start);
+            const int *batch = values + start;
+            for (size_t j = 0; j < group; j++)
+                k[j] = 1;
+
+            for (int level = 0; level < fullLevels; level++)
+            {
+                for (size_t j = 0; j < group; j++)
+                {
+                    __builtin_prefetch(slots.get() + k[j] * 16);
+                    k[j] = 2 * k[j] + (slots[k[j]] < batch[j]);
+                }
+            }
+            for (size_t j = 0; j < group; j++)
+            {
+                if (k[j] <= count)
+                    k[j] = 2 * k[j] + (slots[k[j]] < batch[j]);
+                size_t slot = lowerBoundSlot(k[j]);
+                found[start + j] = slot != 0 && slots[slot] == batch[j];
+            }
+        }
+    }
+};
+
+// Snapshots a tree into an EytzingerIndex; the tree itself is left untouched
+EytzingerIndex freeze(Node *root)
+{
+    vector<int> sorted;
+    inorder_visit(root, [&sorted](int value)
+                  { sorted.push_back(value); });
+    return EytzingerIndex(sorted);
+}
+
+// Read-copy-update for one writer and many readers. A reader announces the
+// grace period it started in; synchronize() opens a new period and waits
+// until no reader is left in an older one. Anything the writer unlinked
+// before calling synchronize() is then unreachable and can be freed.
+class RcuDomain
+{
+public:
+    static const int MAX_READERS = 256;
+
+    static RcuDomain &instance()
+    {
+        static RcuDomain domain;
+        return domain;
+    }
+
+    class ReadGuard
+    {
+    public:
+        ReadGuard() : slot(RcuDomain::instance().readerSlot())
+        {
+            slot.store(RcuDomain::instance().period.load(memory_order_relaxed), memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst); // announce before touching the tree
+        }
+        ~ReadGuard() { slot.store(IDLE, memory_order_release); }
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+
+    private:
+        atomic<uint64_t> &slot;
+    };
+
+    void synchronize()
+    {
+        atomic_thread_fence(memory_order_seq_cst); // unlinks happen before the new period
+        uint64_t current = period.fetch_add(1) + 1;
+        for (Reader &reader : readers)
+        {
+            uint64_t seen;
+            while ((seen = reader.period.load(memory_order_acquire)) != IDLE && seen < current)
+                this_thread::yield();
+        }
+    }
+
+private:
+    static const uint64_t IDLE = 0;
+
+    struct alignas(64) Reader
+    {
+        atomic<bool> inUse{false};
+        atomic<uint64_t> period{IDLE};
+    };
+
+    struct SlotHandle
+    {
+        int index = -1;
+        ~SlotHandle()
+        {
+            if (index >= 0)
+                RcuDomain::instance().readers[index].inUse.store(false);
+        }
+    };
+
+    atomic<uint64_t> period{1};
+    Reader readers[MAX_READERS];
+
+    RcuDomain() = default;
+
+    atomic<uint64_t> &readerSlot()
+    {
+        static thread_local SlotHandle handle;
+        if (handle.index < 0)
+        {
+            for (int i = 0;; i = (i + 1) % MAX_READERS)
+            {
+                bool expected = false;
+                if (readers[i].inUse.compare_exchange_strong(expected, true))
+                {
+                    handle.index = i;
+                    break;
+                }
+            }
+        }
+        return readers[handle.index].period;
+    }
+};
+
+// BST with lock-free readers: find() never blocks and never sees a node
+// change under it. Writers are serialized by a mutex, publish new nodes
+// with release stores and never modify a node a reader might still be on;
+// the two-children remove copies the path down to the successor instead.
+// Unlinked nodes are freed in batches after an RCU grace period.
+class ConcurrentTree
+{
+private:
+    struct RcuNode
+    {
+        int value;
+        atomic<RcuNode *> left;
+        atomic<RcuNode *> right;
+        RcuNode(int v, RcuNode *l = nullptr, RcuNode *r = nullptr) : value(v), left(l), right(r) {}
+    };
+
+    static const size_t RECLAIM_BATCH = 256;
+
+    atomic<RcuNode *> root;
+    mutex writerLock;
+    vector<RcuNode *> retired;
+
+    void retire(RcuNode *node)
+    {
+        retired.push_back(node);
+        if (retired.size() >= RECLAIM_BATCH)
+            reclaim();
+    }
+
+    void reclaim()
+    {
+        RcuDomain::instance().synchronize();
+        for (RcuNode *node : retired)
+            delete node;
+        retired.clear();
+    }
+
+public:
+    ConcurrentTree() : root(nullptr) {}
+    ConcurrentTree(const ConcurrentTree &) = delete;
+    ConcurrentTree &operator=(const ConcurrentTree &) = delete;
+
+    // Must not run concurrently with other operations
+    ~ConcurrentTree()
+    {
+        reclaim();
+        vector<RcuNode *> stack;
+        if (RcuNode *top = root.load())
+            stack.push_back(top);
+        while (!stack.empty())
+        {
+            RcuNode *node = stack.back();
+            stack.pop_back();
+            if (RcuNode *left = node->left.load())
+                stack.push_back(left);
+            if (RcuNode *right = node->right.load())
+                stack.push_back(right);
+            delete node;
+        }
+    }
+
+    bool find(int value)
+    {
+        RcuDomain::ReadGuard guard;
+        RcuNode *current = root.load(memory_order_acquire);
+        while (current)
+        {
+            if (current->value == value)
+                return true;
+            current = (value < current->value ? current->left : current->right).load(memory_order_acquire);
+        }
+        return false;
+    }
+
+    void insert(int value)
+    {
+        lock_guard<mutex> guard(writerLock);
+        atomic<RcuNode *> *link = &root;
+        while (RcuNode *current = link->load(memory_order_relaxed))
+            link = value < current->value ? &current->left : &current->right;
+        link->store(new RcuNode(value), memory_order_release);
+    }
+
+    void remove(int value)
+    {
+        lock_guard<mutex> guard(writerLock);
+        atomic<RcuNode *> *link = &root;
+        RcuNode *target;
+        while ((target = link->load(memory_order_relaxed)) && target->value != value)
+            link = value < target->value ? &target->left : &target->right;
+        if (!target)
+            return;
+
+        RcuNode *left = target->left.load(memory_order_relaxed);
+        RcuNode *right = target->right.load(memory_order_relaxed);
+        if (!left || !right)
+        {
+            // Readers already on target still see its children intact
+            link->store(left ? left : right, memory_order_release);
+            retire(target);
+            return;
+        }
+
+        // Node with two children: build a copy of target holding the
+        // successor's value, plus copies of the path from target->right
+        // down to the successor with the successor left out, then publish
+        // the whole replacement with one store
+        vector<RcuNode *> path;
+        for (RcuNode *node = right; node; node = node->left.load(memory_order_relaxed))
+            path.push_back(node);
+        RcuNode *successor = path.back();
+
+        RcuNode *replacementRight = successor->right.load(memory_order_relaxed);
+        for (size_t i = path.size() - 1; i-- > 0;)
+            replacementRight = new RcuNode(path[i]->value, replacementRight,
+                                           path[i]->right.load(memory_order_relaxed));
+        link->store(new RcuNode(successor->value, left, replacementRight), memory_order_release);
+
+        retire(target);
+        for (RcuNode *node : path)
+            retire(node);
+    }
+};
+
+// Bulk loading. Linking already-ordered nodes into a perfectly balanced
+// tree is O(n): the middle node becomes the root, each half a subtree.
+Node *link_balanced(Node *const *ordered, size_t n)
+{
+    if (n == 0)
+        return nullptr;
+    size_t mid = n / 2;
+    Node *root = ordered[mid];
+    root->size = int(n);
+    root->left = link_balanced(ordered, mid);
+    root->right = link_balanced(ordered + mid + 1, n - mid - 1);
+    return root;
+}
+
+// Builds a balanced tree from a sorted range in O(n), instead of n inserts
+Node *build_balanced(const int *sorted, size_t n)
+{
+    vector<Node *> ordered(n);
+    for (size_t i = 0; i < n; i++)
+        ordered[i] = new Node(sorted[i]);
+    return link_balanced(ordered.data(), n);
+}
+
+// Sorts chunks on separate threads, then merges neighbouring runs pairwise,
+// also in parallel, until one run is left
+void parallel_sort(vector<int> &values, unsigned threads)
+{
+    const size_t SEQUENTIAL_CUTOFF = 1 << 16;
+    if (threads <= 1 || values.size() < SEQUENTIAL_CUTOFF)
+    {
+        sort(values.begin(), values.end());
+        return;
+    }
+
+    vector<size_t> bounds;
+    for (unsigned t = 0; t <= threads; t++)
+        bounds.push_back(values.size() * t / threads);
+
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+        workers.emplace_back([&values, &bounds, t]()
+                             { sort(values.begin() + bounds[t], values.begin() + bounds[t + 1]); });
+    for (thread &worker : workers)
+        worker.join();
+
+    while (bounds.size() > 2)
+    {
+        vector<size_t> merged;
+        workers.clear();
+        for (size_t i = 0; i + 2 < bounds.size(); i += 2)
+        {
+            workers.emplace_back([&values, &bounds, i]()
+                                 { inplace_merge(values.begin() + bounds[i], values.begin() + bounds[i + 1],
+                                                 values.begin() + bounds[i + 2]); });
+            merged.push_back(bounds[i]);
+        }
+        if (bounds.size() % 2 == 0)
+            merged.push_back(bounds[bounds.size() - 2]); // odd run out waits a round
+        merged.push_back(bounds.back());
+        for (thread &worker : workers)
+            worker.join();
+        bounds.swap(merged);
+    }
+}
+
+// Adds a batch of unsorted values in O((n + m) + m log m / threads): sorts the
+// batch in parallel, merges it with the existing nodes in order and relinks
+// everything as a balanced tree. Existing nodes are reused, not copied.
+Node *insert_batch(Node *root, vector<int> values, unsigned threads = thread::hardware_concurrency())
+{
+    parallel_sort(values, threads);
+
+    vector<Node *> existing;
+    vector<Node *> stack;
+    for (Node *current = root; current || !stack.empty(); current = current->right)
+    {
+        for (; current; current = current->left)
+            stack.push_back(current);
+        current = stack.back();
+        stack.pop_back();
+        existing.push_back(current);
+    }
+
+    // Existing keys go first on ties, matching insert's "duplicates go right"
+    vector<Node *> ordered;
+    ordered.reserve(existing.size() + values.size());
+    size_t i = 0;
+    for (int value : values)
+    {
+        while (i < existing.size() && existing[i]->value <= value)
+            ordered.push_back(existing[i++]);
+        ordered.push_back(new Node(value));
+    }
+    ordered.insert(ordered.end(), existing.begin() + i, existing.end());
+
+    return link_balanced(ordered.data(), ordered.size());
+}
+
+// Benchmarks: build with optimizations for meaningful numbers, e.g.
+//   g++ -std=c++17 -O2 -o 07-binary-trees 07-binary-trees.cpp && ./07-binary-trees --bench
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template <typename TreeNode>
+int treeHeight(TreeNode *root)
+{
+    if (!root)
+        return 0;
+    return 1 + max(treeHeight(root->left), treeHeight(root->right));
+}
+
+template <typename TreeNode>
+void benchmarkTree(const string &name, const vector<int> &keys)
+{
+    TreeNode *root = nullptr;
+    auto start = chrono::steady_clock::now();
+    for (int key : keys)
+        root = insert(root, key);
+    double insertMs = elapsedMs(start);
+
+    start = chrono::steady_clock::now();
+    size_t hits = 0;
+    for (int key : keys)
+        hits += find(root, key);
+    double findMs = elapsedMs(start);
+
+    int treeDepth = treeHeight(root);
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i += 2)
+        root = remove(root, keys[i]);
+    double removeMs = elapsedMs(start);
+
+    destroy(root);
+    cout << "  " << name << ": insert " << insertMs << " ms, find " << findMs << " ms ("
+         << hits << " hits), remove half " << removeMs << " ms, height " << treeDepth << endl;
+}
+
+// Same shape as inorder_print, without the I/O
+void inorder_sum_recursive(Node *root, long long &sum)
+{
+    if (!root)
+        return;
+    inorder_sum_recursive(root->left, sum);
+    sum += root->value;
+    inorder_sum_recursive(root->right, sum);
+}
+
+void benchmarkIterative(int n)
+{
+    vector<int> keys(n);
+    iota(keys.begin(), keys.end(), 0);
+    shuffle(keys.begin(), keys.end(), mt19937(7));
+
+    // Pass 0 only warms up the heap, so the timed passes see the same fragmentation
+    cout << "=== Recursive vs iterative BST (" << n << " random keys) ===" << endl;
+    for (int pass = 0; pass < 3; pass++)
+    {
+        bool iterative = pass == 2;
+        Node *root = nullptr;
+
+        auto start = chrono::steady_clock::now();
+        for (int key : keys)
+            root = iterative ? insert_iterative(root, key) : insert(root, key);
+        double insertMs = elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        size_t hits = 0;
+        for (int key : keys)
+            hits += iterative ? find_iterative(root, key) : find(root, key);
+        double findMs = elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        long long sum = 0;
+        if (iterative)
+            inorder_visit(root, [&sum](int value)
+                          { sum += value; });
+        else
+            inorder_sum_recursive(root, sum);
+        double traverseMs = elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < keys.size(); i += 2)
+            root = iterative ? remove_iterative(root, keys[i]) : remove(root, keys[i]);
+        double removeMs = elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        if (iterative)
+            destroy_iterative(root);
+        else
+            destroy(root);
+        double destroyMs = elapsedMs(start);
+
+        if (pass == 0)
+            continue;
+        cout << (iterative ? "  iterative: " : "  recursive: ") << "insert " << insertMs
+             << " ms, find " << findMs << " ms (" << hits << " hits), inorder " << traverseMs
+             << " ms (sum " << sum << "), remove half " << removeMs << " ms, destroy "
+             << destroyMs << " ms" << endl;
+    }
+}
+
+// Builds the degenerate chain that sorted (or reverse-sorted) inserts produce,
+// linking it directly since inserting n sorted keys one by one is O(n^2)
+Node *buildChain(int n, bool leftLeaning)
+{
+    Node *root = nullptr;
+    Node *tail = nullptr;
+    for (int i = 0; i < n; i++)
+    {
+        Node *node = new Node(leftLeaning ? n - 1 - i : i);
+        node->size = n - i;
+        if (!root)
+            root = node;
+        else if (leftLeaning)
+            tail->left = node;
+        else
+            tail->right = node;
+        tail = node;
+    }
+    return root;
+}
+
+// Runs every iterative operation on an n-node chain; the recursive versions
+// overflow the stack long before 10M nodes
+bool runChainTest(int n)
+{
+    bool ok = true;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        bool leftLeaning = pass == 1;
+        Node *root = buildChain(n, leftLeaning);
+
+        ok &= find_iterative(root, n - 1) && find_iterative(root, 0) && !find_iterative(root, n);
+
+        long long count = 0;
+        int previous = -1;
+        bool sorted = true;
+        inorder_visit(root, [&](int value)
+                      {
+            sorted &= value > previous;
+            previous = value;
+            count++; });
+        ok &= sorted && count == n;
+
+        root = remove_iterative(root, n / 2);
+        root = remove_iterative(root, leftLeaning ? 0 : n - 1);
+        root = insert_iterative(root, n / 2);
+        ok &= find_iterative(root, n / 2) && !find_iterative(root, leftLeaning ? 0 : n - 1);
+
+        count = 0;
+        inorder_visit(root, [&count](int)
+                      { count++; });
+        ok &= count == n - 1;
+        ok &= root->size == n - 1 && rank_of(root, n / 2) == n / 2 - leftLeaning;
+
+        destroy_iterative(root);
+        cout << (leftLeaning ? "Left" : "Right") << "-leaning chain of " << n << " nodes: "
+             << (ok ? "ok" : "FAILED") << endl;
+    }
+    cout << "Chain test: " << (ok ? "PASSED" : "FAILED") << endl;
+    return ok;
+}
+
+void benchmarkEytzinger(const vector<int> &sizes)
+{
+    const size_t queries = 4000000;
+    cout << "=== Pointer tree vs frozen Eytzinger index (" << queries << " lookups) ===" << endl;
+    for (int n : sizes)
+    {
+        // Even keys are present, odd probes miss
+        vector<int> keys(n);
+        for (int i = 0; i < n; i++)
+            keys[i] = 2 * i;
+        Node *root = build_balanced(keys.data(), keys.size());
+
+        vector<int> probes(queries);
+        mt19937 rng(n);
+        for (int &probe : probes)
+            probe = int(rng() % (2 * uint64_t(n)));
+
+        auto start = chrono::steady_clock::now();
+        EytzingerIndex index = freeze(root);
+        double freezeMs = elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        size_t treeHits = 0;
+        for (int probe : probes)
+            treeHits += find_iterative(root, probe);
+        double treeMs = elapsedMs(start);
+
+        start = chrono::steady_clock::now();
+        size_t indexHits = 0;
+        for (int probe : probes)
+            indexHits += index.find(probe);
+        double indexMs = elapsedMs(start);
+
+        unique_ptr<bool[]> found(new bool[queries]);
+        start = chrono::steady_clock::now();
+        index.find_many(probes.data(), queries, found.get());
+        double batchMs = elapsedMs(start);
+        size_t batchHits = count(found.get(), found.get() + queries, true);
+
+        cout << "  " << n << " keys: freeze " << freezeMs << " ms, pointer find " << treeMs
+             << " ms, Eytzinger find " << indexMs << " ms, find_many " << batchMs << " ms ("
+             << treeHits << "/" << indexHits << "/" << batchHits << " hits)" << endl;
+        destroy_iterative(root);
+    }
+}
+
+// Resident set size from /proc (Linux only; returns 0 elsewhere)
+long residentKb()
+{
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line))
+    {
+        if (line.compare(0, 6, "VmRSS:") == 0)
+            return atol(line.c_str() + 6);
+    }
+    return 0;
+}
+
+// The IndexedTree runs first: its single big pool is returned to the OS on
+// destruction, while freed malloc'd nodes would stay in the process heap
+void benchmarkIndexed(int n)
+{
+    vector<int> keys(n);
+    iota(keys.begin(), keys.end(), 0);
+    shuffle(keys.begin(), keys.end(), mt19937(11));
+
+    cout << "=== Pointer BST vs IndexedTree (" << n << " random keys) ===" << endl;
+
+    long baseKb = residentKb();
+    auto start = chrono::steady_clock::now();
+    IndexedTree *indexed = new IndexedTree();
+    indexed->reserve(n);
+    for (int key : keys)
+        indexed->insert(key);
+    double insertMs = elapsedMs(start);
+    long indexedKb = residentKb() - baseKb;
+
+    start = chrono::steady_clock::now();
+    size_t hits = 0;
+    for (int key : keys)
+        hits += indexed->find(key);
+    double findMs = elapsedMs(start);
+
+    cout << "  IndexedTree: insert " << insertMs << " ms, find " << findMs << " ms (" << hits
+         << " hits), RSS +" << indexedKb / 1024 << " MB" << endl;
+    cout << "  ";
+    indexed->memory_report();
+    delete indexed;
+
+    baseKb = residentKb();
+    start = chrono::steady_clock::now();
+    Node *root = nullptr;
+    for (int key : keys)
+        root = insert_iterative(root, key);
+    insertMs = elapsedMs(start);
+    long pointerKb = residentKb() - baseKb;
+
+    start = chrono::steady_clock::now();
+    hits = 0;
+    for (int key : keys)
+        hits += find_iterative(root, key);
+    findMs = elapsedMs(start);
+
+    cout << "  pointer BST: insert " << insertMs << " ms, find " << findMs << " ms (" << hits
+         << " hits), RSS +" << pointerKb / 1024 << " MB" << endl;
+    destroy_iterative(root);
+}
+
+void benchmarkBulkLoad(int n)
+{
+    vector<int> keys(n);
+    iota(keys.begin(), keys.end(), 0);
+    shuffle(keys.begin(), keys.end(), mt19937(5));
+    unsigned threads = max(1u, thread::hardware_concurrency());
+
+    cout << "=== Bulk loading " << n << " random keys (" << threads << " threads) ===" << endl;
+
+    auto start = chrono::steady_clock::now();
+    Node *root = nullptr;
+    for (int key : keys)
+        root = insert_iterative(root, key);
+    cout << "  repeated insert:          " << elapsedMs(start) << " ms, height " << treeHeight(root) << endl;
+    destroy_iterative(root);
+
+    vector<int> sorted(keys);
+    sort(sorted.begin(), sorted.end());
+    start = chrono::steady_clock::now();
+    root = build_balanced(sorted.data(), sorted.size());
+    cout << "  build_balanced (presorted): " << elapsedMs(start) << " ms, height " << treeHeight(root) << endl;
+    destroy_iterative(root);
+
+    start = chrono::steady_clock::now();
+    root = insert_batch(nullptr, keys, threads);
+    cout << "  insert_batch into empty:  " << elapsedMs(start) << " ms, height " << treeHeight(root) << endl;
+    destroy_iterative(root);
+
+    // Half the keys are already in the tree, the other half arrive as one batch
+    vector<int> firstHalf(keys.begin(), keys.begin() + n / 2);
+    vector<int> secondHalf(keys.begin() + n / 2, keys.end());
+    root = insert_batch(nullptr, firstHalf, threads);
+    start = chrono::steady_clock::now();
+    root = insert_batch(root, secondHalf, threads);
+    cout << "  insert_batch merge half:  " << elapsedMs(start) << " ms, height " << treeHeight(root) << endl;
+    destroy_iterative(root);
+
+    for (unsigned t = 1; t <= threads; t *= 2)
+    {
+        vector<int> copy(keys);
+        start = chrono::steady_clock::now();
+        parallel_sort(copy, t);
+        cout << "  parallel_sort, " << t << " thread(s): " << elapsedMs(start) << " ms" << endl;
+    }
+}
+
+// Baseline for the read-scaling benchmark: the plain BST behind one mutex
+class MutexTree
+{
+private:
+    mutex lock;
+    Node *root = nullptr;
+
+public:
+    ~MutexTree() { destroy_iterative(root); }
+    bool find(int value)
+    {
+        lock_guard<mutex> guard(lock);
+        return find_iterative(root, value);
+    }
+    void insert(int value)
+    {
+        lock_guard<mutex> guard(lock);
+        root = insert_iterative(root, value);
+    }
+    void remove(int value)
+    {
+        lock_guard<mutex> guard(lock);
+        root = remove_iterative(root, value);
+    }
+};
+
+// One writer keeps inserting and removing while `readers` threads look up
+// random keys for a fixed time; returns millions of lookups per second
+template <typename Tree>
+double readThroughput(int readers, int keyRange, int durationMs)
+{
+    Tree tree;
+    vector<int> keys(keyRange / 2);
+    for (size_t i = 0; i < keys.size(); i++)
+        keys[i] = int(2 * i);
+    shuffle(keys.begin(), keys.end(), mt19937(3));
+    for (int key : keys)
+        tree.insert(key);
+
+    atomic<bool> stop(false);
+    atomic<long long> lookups(0);
+    atomic<long long> hits(0); // consumed so the lookups cannot be optimized away
+    thread writer([&]()
+                  {
+        mt19937 rng(17);
+        while (!stop.load(memory_order_relaxed))
+        {
+            int key = int(rng() % keyRange) | 1; // odd keys come and go
+            tree.insert(key);
+            tree.remove(key);
+        } });
+
+    vector<thread> workers;
+    for (int r = 0; r < readers; r++)
+    {
+        workers.emplace_back([&, r]()
+                             {
+            mt19937 rng(100 + r);
+            long long local = 0;
+            long long found = 0;
+            while (!stop.load(memory_order_relaxed))
+            {
+                for (int i = 0; i < 256; i++)
+                    found += tree.find(int(rng() % keyRange));
+                local += 256;
+            }
+            lookups += local;
+            hits += found; });
+    }
+
+    this_thread::sleep_for(chrono::milliseconds(durationMs));
+    stop = true;
+    writer.join();
+    for (thread &worker : workers)
+        worker.join();
+    return lookups.load() / (durationMs / 1000.0) / 1e6;
+}
+
+void benchmarkConcurrent(int keyRange)
+{
+    int maxReaders = max(1u, thread::hardware_concurrency());
+    vector<int> readerCounts;
+    for (int readers = 1; readers < maxReaders; readers *= 2)
+        readerCounts.push_back(readers);
+    readerCounts.push_back(maxReaders);
+
+    cout << "=== Read throughput with 1 writer (" << keyRange << " key range, Mlookups/s) ===" << endl;
+    for (int readers : readerCounts)
+    {
+        cout << "  " << readers << " reader(s): mutex BST " << readThroughput<MutexTree>(readers, keyRange, 500)
+             << ", ConcurrentTree " << readThroughput<ConcurrentTree>(readers, keyRange, 500) << endl;
+    }
+}
+
+// Answers rank queries the old way, by an in-order walk that stops at value
+int rank_by_walk(Node *root, int value)
+{
+    int count = 0;
+    vector<Node *> stack;
+    for (Node *current = root; current || !stack.empty(); current = current->right)
+    {
+        for (; current; current = current->left)
+            stack.push_back(current);
+        current = stack.back();
+        stack.pop_back();
+        if (current->value >= value)
+            break;
+        count++;
+    }
+    return count;
+}
+
+void benchmarkOrderStatistics(int n)
+{
+    // A balanced base plus random inserts and removes, so sizes have been
+    // updated through every path including the two-children remove
+    vector<int> keys(n);
+    for (int i = 0; i < n; i++)
+        keys[i] = 2 * i;
+    Node *root = build_balanced(keys.data(), keys.size());
+    mt19937 rng(9);
+    for (int i = 0; i < n / 10; i++)
+    {
+        root = insert_iterative(root, int(rng() % (2 * uint64_t(n))) | 1);
+        root = remove(root, int(rng() % (2 * uint64_t(n))) & ~1);
+    }
+
+    const int walkQueries = 200;
+    const int fastQueries = 1000000;
+    vector<int> probes(fastQueries);
+    for (int &probe : probes)
+        probe = int(rng() % (2 * uint64_t(n)));
+
+    cout << "=== Order statistics on " << root->size << " keys ===" << endl;
+
+    auto start = chrono::steady_clock::now();
+    long long walkTotal = 0;
+    for (int i = 0; i < walkQueries; i++)
+        walkTotal += rank_by_walk(root, probes[i]);
+    double walkUs = elapsedMs(start) * 1000 / walkQueries;
+
+    start = chrono::steady_clock::now();
+    long long rankTotal = 0;
+    for (int probe : probes)
+        rankTotal += rank_of(root, probe);
+    double rankUs = elapsedMs(start) * 1000 / fastQueries;
+
+    long long checkTotal = 0;
+    for (int i = 0; i < walkQueries; i++)
+        checkTotal += rank_of(root, probes[i]);
+
+    start = chrono::steady_clock::now();
+    long long selectTotal = 0;
+    for (int probe : probes)
+        selectTotal += select(root, probe % root->size)->value;
+    double selectUs = elapsedMs(start) * 1000 / fastQueries;
+
+    start = chrono::steady_clock::now();
+    long long rangeTotal = 0;
+    for (int i = 0; i + 1 < fastQueries; i += 2)
+        rangeTotal += count_range(root, min(probes[i], probes[i + 1]), max(probes[i], probes[i + 1]));
+    double rangeUs = elapsedMs(start) * 1000 / (fastQueries / 2);
+
+    cout << "  rank by in-order walk: " << walkUs << " us/query" << endl;
+    cout << "  rank_of:     " << rankUs << " us/query (checksum " << rankTotal << ", "
+         << (checkTotal == walkTotal ? "matches walk" : "MISMATCH") << ")" << endl;
+    cout << "  select:      " << selectUs << " us/query (checksum " << selectTotal << ")" << endl;
+    cout << "  count_range: " << rangeUs << " us/query (checksum " << rangeTotal << ")" << endl;
+    destroy_iterative(root);
+}
+
+// The plain BST is quadratic (and deeply recursive) on sorted input, so keep n modest
+void benchmarkBalancing(int n)
+{
+    vector<int> sorted(n);
+    iota(sorted.begin(), sorted.end(), 0);
+    vector<int> reversed(sorted.rbegin(), sorted.rend());
+    vector<int> shuffled = sorted;
+    shuffle(shuffled.begin(), shuffled.end(), mt19937(42));
+
+    cout << "=== Unbalanced BST vs AVL (" << n << " keys) ===" << endl;
+    const pair<string, const vector<int> *> orders[] = {
+        {"sorted", &sorted}, {"reverse-sorted", &reversed}, {"random", &shuffled}};
+    for (const auto &order : orders)
+    {
+        cout << order.first << " keys:" << endl;
+        benchmarkTree<Node>("BST", *order.second);
+        benchmarkTree<AvlNode>("AVL", *order.second);
+    }
+}
+
+// Usage: --bench [name] [n], where name is one of:
+//   all, balance, iterative, eytzinger, indexed, bulk, concurrent, orderstat
+int runBenchmarks(const string &which, int n)
+{
+    bool all = which == "all";
+    bool known = false;
+    if (all || which == "balance")
+    {
+        benchmarkBalancing(n ? n : 10000);
+        known = true;
+    }
+    if (all || which == "iterative")
+    {
+        benchmarkIterative(n ? n : 1000000);
+        known = true;
+    }
+    if (all || which == "eytzinger")
+    {
+        // 100M keys needs ~4 GB; ask for it explicitly with --bench eytzinger 100000000
+        benchmarkEytzinger(n ? vector<int>{n} : vector<int>{1000, 1000000, 10000000});
+        known = true;
+    }
+    if (all || which == "indexed")
+    {
+        benchmarkIndexed(n ? n : 1000000);
+        known = true;
+    }
+    if (all || which == "bulk")
+    {
+        benchmarkBulkLoad(n ? n : 10000000);
+        known = true;
+    }
+    if (all || which == "concurrent")
+    {
+        benchmarkConcurrent(n ? n : 100000);
+        known = true;
+    }
+    if (all || which == "orderstat")
+    {
+        benchmarkOrderStatistics(n ? n : 4000000);
+        known = true;
+    }
+    if (!known)
+    {
+        cout << "Unknown benchmark: " << which << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--bench")
+        return runBenchmarks(argc > 2 ? argv[2] : "all", argc > 3 ? atoi(argv[3]) : 0);
+    if (argc > 1 && string(argv[1]) == "--chain")
+        return runChainTest(argc > 2 ? atoi(argv[2]) : 10000000) ? 0 : 1;
+
+    int values[] = {4, 2, 6, 1, 3, 5, 7};
+    Node *root = nullptr;
+
+    cout << "Inserting values: ";
+    for (int v : values)
+    {
+        cout << v << " ";
+        root = insert(root, v);
+    }
+    cout << endl;
+
+    cout << "Inorder traversal (sorted): ";
+    inorder_print(root);
+    cout << endl;
+
+    cout << "Finding value 5: " << (find(root, 5) ? "Found" : "Not found") << endl;
+    cout << "Finding value 8: " << (find(root, 8) ? "Found" : "Not found") << endl;
+
+    cout << "Removing value 2" << endl;
+    root = remove(root, 2);
+
+    cout << "Inorder traversal after removal: ";
+    inorder_print(root);
+    cout << endl;
+
+    cout << "Keys below 5 (rank): " << rank_of(root, 5) << endl;
+    cout << "Smallest key (select 0): " << select(root, 0)->value << endl;
+    cout << "Third smallest key (select 2): " << select(root, 2)->value << endl;
+    cout << "Keys in [3, 6]: " << count_range(root, 3, 6) << endl;
+
+    destroy(root);
+
+    cout << "\n=== Iterative operations ===" << endl;
+    root = nullptr;
+    for (int v : values)
+        root = insert_iterative(root, v);
+    cout << "Inorder traversal (Morris, no stack): ";
+    inorder_print_iterative(root);
+    cout << endl;
+    cout << "Finding value 5: " << (find_iterative(root, 5) ? "Found" : "Not found") << endl;
+    cout << "Removing value 4 (root, two children)" << endl;
+    root = remove_iterative(root, 4);
+    cout << "Inorder traversal after removal: ";
+    inorder_print_iterative(root);
+    cout << endl;
+
+    cout << "Freezing into an Eytzinger index" << endl;
+    EytzingerIndex index = freeze(root);
+    int lookups[] = {1, 4, 5, 8};
+    bool found[4];
+    index.find_many(lookups, 4, found);
+    for (int i = 0; i < 4; i++)
+        cout << "Index lookup " << lookups[i] << ": " << (found[i] ? "Found" : "Not found") << endl;
+    destroy_iterative(root);
+
+    cout << "\n=== Bulk loading ===" << endl;
+    int sortedValues[] = {1, 2, 3, 4, 5, 6, 7};
+    root = build_balanced(sortedValues, 7);
+    cout << "build_balanced(1..7) root: " << root->value << ", height " << treeHeight(root) << endl;
+    root = insert_batch(root, {12, 9, 0, 10, 11, 8});
+    cout << "After insert_batch {12, 9, 0, 10, 11, 8}: ";
+    inorder_print_iterative(root);
+    cout << "(height " << treeHeight(root) << ")" << endl;
+    destroy_iterative(root);
+
+    cout << "\n=== Concurrent tree with lock-free readers ===" << endl;
+    ConcurrentTree shared;
+    for (int v : values)
+        shared.insert(v);
+    atomic<int> readerHits(0);
+    vector<thread> readerThreads;
+    for (int r = 0; r < 3; r++)
+    {
+        // Readers look up the odd values while the main thread removes the even ones
+        readerThreads.emplace_back([&shared, &readerHits]()
+                                   {
+            for (int v = 1; v <= 7; v += 2)
+                readerHits += shared.find(v); });
+    }
+    shared.remove(4);
+    shared.remove(2);
+    shared.remove(6);
+    for (thread &reader : readerThreads)
+        reader.join();
+    cout << "Readers found " << readerHits.load() << " of 12 odd-value lookups while 4, 2, 6 were removed" << endl;
+    cout << "Finding value 4: " << (shared.find(4) ? "Found" : "Not found") << endl;
+    cout << "Finding value 5: " << (shared.find(5) ? "Found" : "Not found") << endl;
+
+    cout << "\n=== Index-linked tree in one node pool ===" << endl;
+    IndexedTree indexed;
+    for (int v : values)
+        indexed.insert(v);
+    cout << "Inorder traversal: ";
+    indexed.inorder_print();
+    cout << endl;
+    cout << "Removing value 4 (root, two children), then inserting 8" << endl;
+    indexed.remove(4);
+    indexed.insert(8);
+    cout << "Inorder traversal: ";
+    indexed.inorder_print();
+    cout << endl;
+    cout << "Finding value 4: " << (indexed.find(4) ? "Found" : "Not found") << endl;
+    indexed.memory_report();
+
+    cout << "\n=== AVL tree with sorted input ===" << endl;
+    AvlNode *avlRoot = nullptr;
+    cout << "Inserting values 1..15 in order" << endl;
+    for (int v = 1; v <= 15; v++)
+        avlRoot = insert(avlRoot, v);
+    cout << "Height: " << height(avlRoot) << " (a plain BST would have height 15)" << endl;
+
+    cout << "Removing value 8 (root, two children)" << endl;
+    avlRoot = remove(avlRoot, 8);
+    cout << "Inorder traversal after removal: ";
+    inorder_print(avlRoot);
+    cout << endl;
+    cout << "Finding value 8: " << (find(avlRoot, 8) ? "Found" : "Not found") << endl;
+
+    destroy(avlRoot);
     return 0;
 }
\ No newline at end of file
@@ -1,6 +1,28 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <functional>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
 using namespace std;
 
 int add_one(int x)
@@ -21,6 +43,8 @@ void apply_and_print(int (*f)(int), int value)
 int add(int a, int b) { return a + b; }
 int subtract(int a, int b) { return a - b; }
 int multiply(int a, int b) { return a * b; }
+// Division by zero gives 0 and INT_MIN / -1 wraps to INT_MIN instead of trapping
+int divide(int a, int b) { return b == 0 ? 0 : b == -1 ? int(0u - unsigned(a)) : a / b; }
 
 // Calculator using function pointers
 void calculator()
@@ -55,58 +79,2003 @@ void bubbleSort(int arr[], int n, bool (*compare)(int, int))
 bool ascending(int a, int b) { return a > b; }
 bool descending(int a, int b) { return a < b; }
 
-void sortingExample()
+// Pattern-defeating quicksort (Orson Peters' pdqsort). The comparator is a
+// template parameter, so any callable works and its body is inlined into
+// the sort instead of being called through a pointer for every comparison.
+// compare(a, b) means the same as in bubbleSort: true when a belongs after b.
+const int PDQ_INSERTION_SORT_THRESHOLD = 24;
+const int PDQ_NINTHER_THRESHOLD = 128;
+const int PDQ_PARTIAL_INSERTION_LIMIT = 8;
+const int PDQ_BLOCK_SIZE = 64;
+
+template <typename T, typename Less>
+void pdqInsertionSort(T *begin, T *end, Less less)
 {
-    cout << "\n=== Sorting with function pointers ===" << endl;
-    int arr1[] = {64, 34, 25, 12, 22, 11, 90};
-    int arr2[] = {64, 34, 25, 12, 22, 11, 90};
-    int n = 7;
+    if (begin == end)
+        return;
+    for (T *current = begin + 1; current != end; ++current)
+    {
+        T *sift = current;
+        if (less(*sift, *(sift - 1)))
+        {
+            T value = move(*sift);
+            do
+            {
+                *sift = move(*(sift - 1));
+                --sift;
+            } while (sift != begin && less(value, *(sift - 1)));
+            *sift = move(value);
+        }
+    }
+}
 
-    cout << "Original array: ";
-    for (int i = 0; i < n; i++)
-        cout << arr1[i] << " ";
-    cout << endl;
+// Like pdqInsertionSort, but relies on *(begin - 1) being no greater than
+// anything in the range, which saves the bounds check in the inner loop
+template <typename T, typename Less>
+void pdqUnguardedInsertionSort(T *begin, T *end, Less less)
+{
+    if (begin == end)
+        return;
+    for (T *current = begin + 1; current != end; ++current)
+    {
+        T *sift = current;
+        if (less(*sift, *(sift - 1)))
+        {
+            T value = move(*sift);
+            do
+            {
+                *sift = move(*(sift - 1));
+                --sift;
+            } while (less(value, *(sift - 1)));
+            *sift = move(value);
+        }
+    }
+}
 
-    bubbleSort(arr1, n, ascending);
-    cout << "Ascending sort: ";
-    for (int i = 0; i < n; i++)
-        cout << arr1[i] << " ";
-    cout << endl;
+// Insertion sort that gives up after a few element moves; returns whether it finished
+template <typename T, typename Less>
+bool pdqPartialInsertionSort(T *begin, T *end, Less less)
+{
+    if (begin == end)
+        return true;
+    ptrdiff_t moves = 0;
+    for (T *current = begin + 1; current != end; ++current)
+    {
+        T *sift = current;
+        if (less(*sift, *(sift - 1)))
+        {
+            T value = move(*sift);
+            do
+            {
+                *sift = move(*(sift - 1));
+                --sift;
+            } while (sift != begin && less(value, *(sift - 1)));
+            *sift = move(value);
+            moves += current - sift;
+        }
+        if (moves > PDQ_PARTIAL_INSERTION_LIMIT)
+            return false;
+    }
+    return true;
+}
 
-    bubbleSort(arr2, n, descending);
-    cout << "Descending sort: ";
-    for (int i = 0; i < n; i++)
-        cout << arr2[i] << " ";
-    cout << endl;
+template <typename T, typename Less>
+void pdqSort3(T *a, T *b, T *c, Less less)
+{
+    if (less(*b, *a))
+        swap(*a, *b);
+    if (less(*c, *b))
+        swap(*b, *c);
+    if (less(*b, *a))
+        swap(*a, *b);
 }
 
-// Modern approach with std::function
-void modernApproach()
+// Heapsort fallback: O(n log n) whatever the input, used when quicksort
+// keeps picking bad pivots
+template <typename T, typename Less>
+void pdqSiftDown(T *heap, ptrdiff_t root, ptrdiff_t size, Less less)
 {
-    cout << "\n=== Modern approach with std::function ===" << endl;
+    T value = move(heap[root]);
+    for (ptrdiff_t child; (child = 2 * root + 1) < size; root = child)
+    {
+        if (child + 1 < size && less(heap[child], heap[child + 1]))
+            child++;
+        if (!less(value, heap[child]))
+            break;
+        heap[root] = move(heap[child]);
+    }
+    heap[root] = move(value);
+}
 
-    vector<function<int(int, int)>> operations = {
-        [](int a, int b)
-        { return a + b; },
-        [](int a, int b)
-        { return a - b; },
-        [](int a, int b)
-        { return a * b; },
-        [](int a, int b)
-        { return a / b; }};
+template <typename T, typename Less>
+void pdqHeapSort(T *begin, T *end, Less less)
+{
+    ptrdiff_t size = end - begin;
+    for (ptrdiff_t i = size / 2; i-- > 0;)
+        pdqSiftDown(begin, i, size, less);
+    for (ptrdiff_t last = size - 1; last > 0; last--)
+    {
+        swap(begin[0], begin[last]);
+        pdqSiftDown(begin, 0, last, less);
+    }
+}
 
-    vector<string> names = {"Add", "Subtract", "Multiply", "Divide"};
+// Partitions [begin, end) around the pivot in *begin: smaller elements to
+// the left, greater or equal to the right. Also reports whether the range
+// was already partitioned, which hints that it might be sorted.
+template <typename T, typename Less>
+pair<T *, bool> pdqPartitionRight(T *begin, T *end, Less less)
+{
+    T pivot = move(*begin);
+    T *first = begin;
+    T *last = end;
 
-    int a = 20, b = 4;
+    // The median-of-3 pivot selection guarantees these loops stop
+    while (less(*++first, pivot))
+        ;
+    if (first - 1 == begin)
+        while (first < last && !less(*--last, pivot))
+            ;
+    else
+        while (!less(*--last, pivot))
+            ;
 
-    for (size_t i = 0; i < operations.size(); i++)
+    bool alreadyPartitioned = first >= last;
+    while (first < last)
     {
-        cout << names[i] << ": " << operations[i](a, b) << endl;
+        swap(*first, *last);
+        while (less(*++first, pivot))
+            ;
+        while (!less(*--last, pivot))
+            ;
+    }
+
+    T *pivotPos = first - 1;
+    *begin = move(*pivotPos);
+    *pivotPos = move(pivot);
+    return {pivotPos, alreadyPartitioned};
+}
+
+// Same contract as pdqPartitionRight, but branchless (BlockQuicksort): the
+// comparisons only record offsets of misplaced elements into small buffers,
+// and the swaps happen afterwards, so there are no mispredicted branches
+template <typename T, typename Less>
+pair<T *, bool> pdqPartitionRightBranchless(T *begin, T *end, Less less)
+{
+    T pivot = move(*begin);
+    T *first = begin;
+    T *last = end;
+
+    while (less(*++first, pivot))
+        ;
+    if (first - 1 == begin)
+        while (first < last && !less(*--last, pivot))
+            ;
+    else
+        while (!less(*--last, pivot))
+            ;
+
+    bool alreadyPartitioned = first >= last;
+    if (!alreadyPartitioned)
+    {
+        swap(*first, *last);
+        ++first;
+
+        alignas(64) unsigned char offsetsLeft[PDQ_BLOCK_SIZE];
+        alignas(64) unsigned char offsetsRight[PDQ_BLOCK_SIZE];
+        T *leftBase = first;
+        T *rightBase = last;
+        size_t numLeft = 0, numRight = 0, startLeft = 0, startRight = 0;
+
+        while (first < last)
+        {
+            // Fill whichever buffer is empty; split the rest evenly when both are
+            size_t unknown = last - first;
+            size_t leftSplit = numLeft == 0 ? (numRight == 0 ? unknown / 2 : unknown) : 0;
+            size_t rightSplit = numRight == 0 ? unknown - leftSplit : 0;
+
+            if (leftSplit > size_t(PDQ_BLOCK_SIZE))
+                leftSplit = PDQ_BLOCK_SIZE;
+            for (size_t i = 0; i < leftSplit; i++)
+            {
+                offsetsLeft[numLeft] = (unsigned char)i;
+                numLeft += !less(*first, pivot);
+                ++first;
+            }
+
+            if (rightSplit > size_t(PDQ_BLOCK_SIZE))
+                rightSplit = PDQ_BLOCK_SIZE;
+            for (size_t i = 0; i < rightSplit;)
+            {
+                offsetsRight[numRight] = (unsigned char)++i;
+                numRight += less(*--last, pivot);
+            }
+
+            size_t num = min(numLeft, numRight);
+            for (size_t i = 0; i < num; i++)
+                swap(leftBase[offsetsLeft[startLeft + i]], rightBase[-ptrdiff_t(offsetsRight[startRight + i])]);
+            numLeft -= num;
+            numRight -= num;
+            startLeft += num;
+            startRight += num;
+            if (numLeft == 0)
+            {
+                startLeft = 0;
+                leftBase = first;
+            }
+            if (numRight == 0)
+            {
+                startRight = 0;
+                rightBase = last;
+            }
+        }
+
+        // One buffer may still hold misplaced elements; move them to the boundary
+        if (numLeft)
+        {
+            while (numLeft--)
+                swap(leftBase[offsetsLeft[startLeft + numLeft]], *--last);
+            first = last;
+        }
+        if (numRight)
+        {
+            while (numRight--)
+            {
+                swap(rightBase[-ptrdiff_t(offsetsRight[startRight + numRight])], *first);
+                ++first;
+            }
+            last = first;
+        }
+    }
+
+    T *pivotPos = first - 1;
+    *begin = move(*pivotPos);
+    *pivotPos = move(pivot);
+    return {pivotPos, alreadyPartitioned};
+}
+
+// Puts elements equal to the pivot on the left. Used when the pivot equals
+// the element just before the range, so the left part is all equal keys.
+template <typename T, typename Less>
+T *pdqPartitionLeft(T *begin, T *end, Less less)
+{
+    T pivot = move(*begin);
+    T *first = begin;
+    T *last = end;
+
+    while (less(pivot, *--last))
+        ;
+    if (last + 1 == end)
+        while (first < last && !less(pivot, *++first))
+            ;
+    else
+        while (!less(pivot, *++first))
+            ;
+
+    while (first < last)
+    {
+        swap(*first, *last);
+        while (less(pivot, *--last))
+            ;
+        while (!less(pivot, *++first))
+            ;
+    }
+
+    T *pivotPos = last;
+    *begin = move(*pivotPos);
+    *pivotPos = move(pivot);
+    return pivotPos;
+}
+
+template <bool Branchless, typename T, typename Less>
+void pdqLoop(T *begin, T *end, Less less, int badAllowed, bool leftmost)
+{
+    for (;;)
+    {
+        ptrdiff_t size = end - begin;
+        if (size < PDQ_INSERTION_SORT_THRESHOLD)
+        {
+            if (leftmost)
+                pdqInsertionSort(begin, end, less);
+            else
+                pdqUnguardedInsertionSort(begin, end, less);
+            return;
+        }
+
+        // Median of 3, or pseudo-median of 9 for larger ranges, ends up in *begin
+        ptrdiff_t half = size / 2;
+        if (size > PDQ_NINTHER_THRESHOLD)
+        {
+            pdqSort3(begin, begin + half, end - 1, less);
+            pdqSort3(begin + 1, begin + (half - 1), end - 2, less);
+            pdqSort3(begin + 2, begin + (half + 1), end - 3, less);
+            pdqSort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+            swap(*begin, *(begin + half));
+        }
+        else
+            pdqSort3(begin + half, begin, end - 1, less);
+
+        // Nothing in the range is smaller than *(begin - 1); if the pivot equals
+        // it, every key equal to the pivot can be split off and left alone
+        if (!leftmost && !less(*(begin - 1), *begin))
+        {
+            begin = pdqPartitionLeft(begin, end, less) + 1;
+            continue;
+        }
+
+        pair<T *, bool> partition = Branchless ? pdqPartitionRightBranchless(begin, end, less)
+                                               : pdqPartitionRight(begin, end, less);
+        T *pivotPos = partition.first;
+        ptrdiff_t leftSize = pivotPos - begin;
+        ptrdiff_t rightSize = end - (pivotPos + 1);
+
+        if (leftSize < size / 8 || rightSize < size / 8)
+        {
+            // Too many bad pivots: stop trusting quicksort
+            if (--badAllowed == 0)
+            {
+                pdqHeapSort(begin, end, less);
+                return;
+            }
+
+            // Break up patterns that keep producing bad pivots
+            if (leftSize >= PDQ_INSERTION_SORT_THRESHOLD)
+            {
+                swap(begin[0], begin[leftSize / 4]);
+                swap(pivotPos[-1], pivotPos[-leftSize / 4]);
+                if (leftSize > PDQ_NINTHER_THRESHOLD)
+                {
+                    swap(begin[1], begin[leftSize / 4 + 1]);
+                    swap(begin[2], begin[leftSize / 4 + 2]);
+                    swap(pivotPos[-2], pivotPos[-(leftSize / 4 + 1)]);
+                    swap(pivotPos[-3], pivotPos[-(leftSize / 4 + 2)]);
+                }
+            }
+            if (rightSize >= PDQ_INSERTION_SORT_THRESHOLD)
+            {
+                swap(pivotPos[1], pivotPos[1 + rightSize / 4]);
+                swap(end[-1], end[-rightSize / 4]);
+                if (rightSize > PDQ_NINTHER_THRESHOLD)
+                {
+                    swap(pivotPos[2], pivotPos[2 + rightSize / 4]);
+                    swap(pivotPos[3], pivotPos[3 + rightSize / 4]);
+                    swap(end[-2], end[-(1 + rightSize / 4)]);
+                    swap(end[-3], end[-(2 + rightSize / 4)]);
+                }
+            }
+        }
+        else if (partition.second && pdqPartialInsertionSort(begin, pivotPos, less) &&
+                 pdqPartialInsertionSort(pivotPos + 1, end, less))
+        {
+            // Balanced partition with no swaps needed: the input was (nearly) sorted
+            return;
+        }
+
+        // Recurse into the left part, loop on the right one
+        pdqLoop<Branchless>(begin, pivotPos, less, badAllowed, leftmost);
+        begin = pivotPos + 1;
+        leftmost = false;
+    }
+}
+
+template <typename T, typename Compare>
+void pdqSort(T arr[], int n, Compare compare)
+{
+    if (n < 2)
+        return;
+    auto less = [&compare](const T &a, const T &b)
+    { return compare(b, a); };
+
+    int badAllowed = 0;
+    for (int size = n; size > 1; size >>= 1)
+        badAllowed++;
+
+    // Branchless partitioning pays off when comparisons are cheap
+    pdqLoop<is_arithmetic<T>::value>(arr, arr + n, less, badAllowed, true);
+}
+
+// Fork-join task pool with work stealing. Every thread owns a deque: it
+// pushes and pops its own tasks at the back (newest, cache-warm work first)
+// while idle threads steal from the front (oldest, usually largest tasks).
+// The thread that calls wait() is slot 0 and helps run tasks while it waits.
+class WorkStealingPool
+{
+public:
+    // Counts the outstanding tasks of one fork-join region
+    struct TaskGroup
+    {
+        atomic<int> pending{0};
+    };
+
+    explicit WorkStealingPool(unsigned threads) : queues(max(1u, threads)), queued(0), stopping(false)
+    {
+        for (auto &queue : queues)
+            queue.reset(new WorkerQueue());
+        for (unsigned i = 1; i < queues.size(); i++)
+            workers.emplace_back([this, i]()
+                                 { workerLoop(i); });
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            lock_guard<mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (thread &worker : workers)
+            worker.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    unsigned size() const { return unsigned(queues.size()); }
+
+    template <typename Task>
+    void spawn(TaskGroup &group, Task task)
+    {
+        group.pending++;
+        WorkerQueue &queue = *queues[currentSlot()];
+        {
+            lock_guard<mutex> guard(queue.lock);
+            queue.tasks.emplace_back([&group, task]()
+                                     {
+                task();
+                group.pending--; });
+        }
+        queued++;
+        {
+            // Pairs with the predicate check in workerLoop so the wake-up cannot be lost
+            lock_guard<mutex> guard(sleepLock);
+        }
+        wakeUp.notify_one();
+    }
+
+    // Runs queued tasks until every task of the group has finished
+    void wait(TaskGroup &group)
+    {
+        unsigned slot = currentSlot();
+        while (group.pending.load() > 0)
+        {
+            if (!runOne(slot))
+                this_thread::yield();
+        }
+    }
+
+private:
+    struct WorkerQueue
+    {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+
+    vector<unique_ptr<WorkerQueue>> queues;
+    vector<thread> workers;
+    atomic<int> queued;
+    mutex sleepLock;
+    condition_variable wakeUp;
+    bool stopping;
+
+    static unsigned &slotOfThisThread()
+    {
+        static thread_local unsigned slot = 0;
+        return slot;
+    }
+
+    unsigned currentSlot() const { return slotOfThisThread(); }
+
+    bool runOne(unsigned slot)
+    {
+        function<void()> task;
+        {
+            WorkerQueue &own = *queues[slot];
+            lock_guard<mutex> guard(own.lock);
+            if (!own.tasks.empty())
+            {
+                task = move(own.tasks.back());
+                own.tasks.pop_back();
+            }
+        }
+        for (unsigned i = 1; !task && i < queues.size(); i++)
+        {
+            WorkerQueue &victim = *queues[(slot + i) % queues.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        if (!task)
+            return false;
+        queued--;
+        task();
+        return true;
+    }
+
+    void workerLoop(unsigned slot)
+    {
+        slotOfThisThread() = slot;
+        for (;;)
+        {
+            if (runOne(slot))
+                continue;
+            unique_lock<mutex> guard(sleepLock);
+            wakeUp.wait(guard, [this]()
+                        { return stopping || queued.load() > 0; });
+            if (stopping)
+                return;
+        }
+    }
+};
+
+// Parallel merge sort on a WorkStealingPool. Both halves are sorted as
+// separate tasks, then merged by a parallel merge that splits at the median
+// of the larger run. Ranges below the cutoff use pdqSort / std::merge.
+const int PARALLEL_SORT_CUTOFF = 1 << 15;
+
+template <typename T, typename Compare>
+void parallelMerge(const T *left, int leftSize, const T *right, int rightSize, T *out,
+                   Compare compare, WorkStealingPool &pool)
+{
+    auto less = [&compare](const T &a, const T &b)
+    { return compare(b, a); };
+
+    if (leftSize + rightSize <= PARALLEL_SORT_CUTOFF)
+    {
+        merge(left, left + leftSize, right, right + rightSize, out, less);
+        return;
+    }
+    if (leftSize < rightSize)
+    {
+        swap(left, right);
+        swap(leftSize, rightSize);
+    }
+
+    int leftMid = leftSize / 2;
+    int rightMid = int(lower_bound(right, right + rightSize, left[leftMid], less) - right);
+    out[leftMid + rightMid] = left[leftMid];
+
+    WorkStealingPool::TaskGroup group;
+    pool.spawn(group, [=, &pool]()
+               { parallelMerge(left, leftMid, right, rightMid, out, compare, pool); });
+    parallelMerge(left + leftMid + 1, leftSize - leftMid - 1, right + rightMid, rightSize - rightMid,
+                  out + leftMid + rightMid + 1, compare, pool);
+    pool.wait(group);
+}
+
+// Sorts data[0, n); the result ends up in scratch when intoScratch is set
+template <typename T, typename Compare>
+void parallelMergeSort(T *data, T *scratch, int n, bool intoScratch, Compare compare, WorkStealingPool &pool)
+{
+    if (n <= PARALLEL_SORT_CUTOFF)
+    {
+        pdqSort(data, n, compare);
+        if (intoScratch)
+            copy(data, data + n, scratch);
+        return;
+    }
+
+    int half = n / 2;
+    WorkStealingPool::TaskGroup group;
+    pool.spawn(group, [=, &pool]()
+               { parallelMergeSort(data, scratch, half, !intoScratch, compare, pool); });
+    parallelMergeSort(data + half, scratch + half, n - half, !intoScratch, compare, pool);
+    pool.wait(group);
+
+    // The sorted halves sit in the other buffer; merge them into this one
+    T *from = intoScratch ? data : scratch;
+    T *to = intoScratch ? scratch : data;
+    parallelMerge(from, half, from + half, n - half, to, compare, pool);
+}
+
+// compare has the same meaning as for bubbleSort and pdqSort
+template <typename T, typename Compare>
+void parallelSort(T arr[], int n, Compare compare, WorkStealingPool &pool)
+{
+    if (pool.size() == 1 || n <= PARALLEL_SORT_CUTOFF)
+    {
+        pdqSort(arr, n, compare);
+        return;
+    }
+    vector<T> scratch(n);
+    parallelMergeSort(arr, scratch.data(), n, false, compare, pool);
+}
+
+template <typename T, typename Compare>
+void parallelSort(T arr[], int n, Compare compare, unsigned threads = thread::hardware_concurrency())
+{
+    WorkStealingPool pool(threads);
+    parallelSort(arr, n, compare, pool);
+}
+
+// Bitonic sorting network for int arrays. A sorting network does the same
+// compare-exchanges whatever the data, so there is nothing to mispredict and
+// each step is a vector min/max over 8 (AVX2) or 4 (SSE2) lanes at once.
+// Blocks of up to 256 ints are padded to a power of two and sorted in one
+// network; longer arrays are sorted in 256-int runs joined by a vector merge.
+const int NETWORK_BLOCK = 256;
+
+// Sorts m ints (a power of two, 8 <= m <= NETWORK_BLOCK) in place
+typedef void (*NetworkBlockFn)(int *x, int m, bool descendingOrder);
+// Merges ascending runs a and b into out (no overlap)
+typedef void (*NetworkMergeFn)(const int *a, int na, const int *b, int nb, int *out);
+
+void networkBlockScalar(int *x, int m, bool descendingOrder)
+{
+    for (int k = 2; k <= m; k <<= 1)
+    {
+        for (int j = k >> 1; j > 0; j >>= 1)
+        {
+            for (int i = 0; i < m; i++)
+            {
+                int partner = i ^ j;
+                if (partner <= i)
+                    continue;
+                bool up = ((i & k) == 0) != descendingOrder;
+                int lo = min(x[i], x[partner]);
+                int hi = max(x[i], x[partner]);
+                x[i] = up ? lo : hi;
+                x[partner] = up ? hi : lo;
+            }
+        }
+    }
+}
+
+void networkMergeScalar(const int *a, int na, const int *b, int nb, int *out)
+{
+    merge(a, a + na, b, b + nb, out);
+}
+
+// Finishes a vector merge: the 8 (or 4) values still held in registers plus
+// whatever is left of both runs, where at least one of them is shorter
+// than a vector
+void mergeTails(const int *held, int heldCount, const int *a, int na, const int *b, int nb, int *out)
+{
+    const int *shortRun = na < nb ? a : b;
+    int shortCount = min(na, nb);
+    const int *longRun = na < nb ? b : a;
+    int longCount = max(na, nb);
+    int small[16];
+    merge(held, held + heldCount, shortRun, shortRun + shortCount, small);
+    merge(small, small + heldCount + shortCount, longRun, longRun + longCount, out);
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__((target("sse2"))) inline __m128i sse2Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+__attribute__((target("sse2"))) inline __m128i sse2Min(__m128i a, __m128i b)
+{
+    return sse2Select(_mm_cmpgt_epi32(a, b), b, a);
+}
+
+__attribute__((target("sse2"))) inline __m128i sse2Max(__m128i a, __m128i b)
+{
+    return sse2Select(_mm_cmpgt_epi32(a, b), a, b);
+}
+
+// One network step inside a 4-lane vector: lane i pairs with lane i ^ j
+__attribute__((target("sse2"))) inline __m128i sse2InLaneStep(__m128i v, int j, __m128i takeMin)
+{
+    __m128i partner = j == 1 ? _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1))
+                             : _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    return sse2Select(takeMin, sse2Min(v, partner), sse2Max(v, partner));
+}
+
+__attribute__((target("sse2"))) void networkBlockSSE2(int *x, int m, bool descendingOrder)
+{
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i flip = descendingOrder ? _mm_set1_epi32(-1) : zero;
+    for (int k = 2; k <= m; k <<= 1)
+    {
+        for (int j = k >> 1; j > 0; j >>= 1)
+        {
+            for (int i = 0; i < m; i += 4)
+            {
+                __m128i *p = reinterpret_cast<__m128i *>(x + i);
+                if (j >= 4)
+                {
+                    if (i & j)
+                        continue;
+                    __m128i *q = reinterpret_cast<__m128i *>(x + i + j);
+                    __m128i a = _mm_loadu_si128(p);
+                    __m128i b = _mm_loadu_si128(q);
+                    bool up = ((i & k) == 0) != descendingOrder;
+                    _mm_storeu_si128(p, up ? sse2Min(a, b) : sse2Max(a, b));
+                    _mm_storeu_si128(q, up ? sse2Max(a, b) : sse2Min(a, b));
+                    continue;
+                }
+                // Lane takes the min when it is the lower of its pair in an ascending block
+                __m128i index = _mm_add_epi32(_mm_set1_epi32(i), lanes);
+                __m128i lower = _mm_cmpeq_epi32(_mm_and_si128(index, _mm_set1_epi32(j)), zero);
+                __m128i up = _mm_xor_si128(_mm_cmpeq_epi32(_mm_and_si128(index, _mm_set1_epi32(k)), zero), flip);
+                __m128i takeMin = _mm_cmpeq_epi32(lower, up);
+                _mm_storeu_si128(p, sse2InLaneStep(_mm_loadu_si128(p), j, takeMin));
+            }
+        }
     }
 }
 
-int main()
+// Merges two ascending 4-lane vectors: lo gets the 4 smallest values, hi the rest
+__attribute__((target("sse2"))) inline void sse2Merge4x4(__m128i a, __m128i b, __m128i &lo, __m128i &hi)
+{
+    const __m128i lowerOf2 = _mm_setr_epi32(-1, 0, -1, 0);
+    const __m128i lowerOf4 = _mm_setr_epi32(-1, -1, 0, 0);
+    __m128i reversed = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 1, 2, 3));
+    lo = sse2Min(a, reversed);
+    hi = sse2Max(a, reversed);
+    lo = sse2InLaneStep(sse2InLaneStep(lo, 2, lowerOf4), 1, lowerOf2);
+    hi = sse2InLaneStep(sse2InLaneStep(hi, 2, lowerOf4), 1, lowerOf2);
+}
+
+__attribute__((target("sse2"))) void networkMergeSSE2(const int *a, int na, const int *b, int nb, int *out)
 {
+    if (na < 4 || nb < 4)
+    {
+        merge(a, a + na, b, b + nb, out);
+        return;
+    }
+    __m128i held = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+    __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+    int ia = 4, ib = 4;
+    for (;;)
+    {
+        __m128i lo, hi;
+        sse2Merge4x4(held, next, lo, hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), lo);
+        out += 4;
+        held = hi;
+        if (na - ia < 4 || nb - ib < 4)
+            break;
+        // Take the next vector from the run whose head is smaller
+        if (a[ia] < b[ib])
+        {
+            next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + ia));
+            ia += 4;
+        }
+        else
+        {
+            next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + ib));
+            ib += 4;
+        }
+    }
+    alignas(16) int rest[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(rest), held);
+    mergeTails(rest, 4, a + ia, na - ia, b + ib, nb - ib, out);
+}
+
+// One network step inside an 8-lane vector: lane i pairs with lane i ^ j
+__attribute__((target("avx2"))) inline __m256i avx2InLaneStep(__m256i v, __m256i partnerIndex, __m256i takeMin)
+{
+    __m256i partner = _mm256_permutevar8x32_epi32(v, partnerIndex);
+    return _mm256_blendv_epi8(_mm256_max_epi32(v, partner), _mm256_min_epi32(v, partner), takeMin);
+}
+
+__attribute__((target("avx2"))) void networkBlockAVX2(int *x, int m, bool descendingOrder)
+{
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i flip = descendingOrder ? _mm256_set1_epi32(-1) : zero;
+    for (int k = 2; k <= m; k <<= 1)
+    {
+        for (int j = k >> 1; j > 0; j >>= 1)
+        {
+            __m256i partnerIndex = _mm256_xor_si256(lanes, _mm256_set1_epi32(j));
+            for (int i = 0; i < m; i += 8)
+            {
+                __m256i *p = reinterpret_cast<__m256i *>(x + i);
+                if (j >= 8)
+                {
+                    if (i & j)
+                        continue;
+                    __m256i *q = reinterpret_cast<__m256i *>(x + i + j);
+                    __m256i a = _mm256_loadu_si256(p);
+                    __m256i b = _mm256_loadu_si256(q);
+                    bool up = ((i & k) == 0) != descendingOrder;
+                    _mm256_storeu_si256(p, up ? _mm256_min_epi32(a, b) : _mm256_max_epi32(a, b));
+                    _mm256_storeu_si256(q, up ? _mm256_max_epi32(a, b) : _mm256_min_epi32(a, b));
+                    continue;
+                }
+                __m256i index = _mm256_add_epi32(_mm256_set1_epi32(i), lanes);
+                __m256i lower = _mm256_cmpeq_epi32(_mm256_and_si256(index, _mm256_set1_epi32(j)), zero);
+                __m256i up = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_and_si256(index, _mm256_set1_epi32(k)), zero), flip);
+                __m256i takeMin = _mm256_cmpeq_epi32(lower, up);
+                _mm256_storeu_si256(p, avx2InLaneStep(_mm256_loadu_si256(p), partnerIndex, takeMin));
+            }
+        }
+    }
+}
+
+// Merges two ascending 8-lane vectors: lo gets the 8 smallest values, hi the rest
+__attribute__((target("avx2"))) inline void avx2Merge8x8(__m256i a, __m256i b, __m256i &lo, __m256i &hi)
+{
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i reversed = _mm256_permutevar8x32_epi32(b, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    lo = _mm256_min_epi32(a, reversed);
+    hi = _mm256_max_epi32(a, reversed);
+    for (int j = 4; j > 0; j >>= 1)
+    {
+        __m256i partnerIndex = _mm256_xor_si256(lanes, _mm256_set1_epi32(j));
+        __m256i lower = _mm256_cmpeq_epi32(_mm256_and_si256(lanes, _mm256_set1_epi32(j)), zero);
+        lo = avx2InLaneStep(lo, partnerIndex, lower);
+        hi = avx2InLaneStep(hi, partnerIndex, lower);
+    }
+}
+
+__attribute__((target("avx2"))) void networkMergeAVX2(const int *a, int na, const int *b, int nb, int *out)
+{
+    if (na < 8 || nb < 8)
+    {
+        merge(a, a + na, b, b + nb, out);
+        return;
+    }
+    __m256i held = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+    __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+    int ia = 8, ib = 8;
+    for (;;)
+    {
+        __m256i lo, hi;
+        avx2Merge8x8(held, next, lo, hi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), lo);
+        out += 8;
+        held = hi;
+        if (na - ia < 8 || nb - ib < 8)
+            break;
+        if (a[ia] < b[ib])
+        {
+            next = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + ia));
+            ia += 8;
+        }
+        else
+        {
+            next = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + ib));
+            ib += 8;
+        }
+    }
+    alignas(32) int rest[8];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(rest), held);
+    mergeTails(rest, 8, a + ia, na - ia, b + ib, nb - ib, out);
+}
+#endif
+
+struct NetworkKernels
+{
+    NetworkBlockFn sortBlock;
+    NetworkMergeFn mergeRuns;
+    const char *name;
+};
+
+NetworkKernels selectNetworkKernels()
+{
+#ifdef HAVE_X86_SIMD
+    if (__builtin_cpu_supports("avx2"))
+        return {networkBlockAVX2, networkMergeAVX2, "AVX2"};
+    if (__builtin_cpu_supports("sse2"))
+        return {networkBlockSSE2, networkMergeSSE2, "SSE2"};
+#endif
+    return {networkBlockScalar, networkMergeScalar, "scalar"};
+}
+
+const NetworkKernels networkKernels = selectNetworkKernels();
+
+// Pads up to a power of two with values that sort to the end, sorts, copies back
+void networkSortBlock(int arr[], int n, bool descendingOrder)
+{
+    alignas(32) int block[NETWORK_BLOCK];
+    int m = 8;
+    while (m < n)
+        m <<= 1;
+    copy(arr, arr + n, block);
+    fill(block + n, block + m, descendingOrder ? INT_MIN : INT_MAX);
+    networkKernels.sortBlock(block, m, descendingOrder);
+    copy(block, block + n, arr);
+}
+
+void networkSort(int arr[], int n, bool descendingOrder)
+{
+    if (n <= 1)
+        return;
+    if (n <= NETWORK_BLOCK)
+    {
+        networkSortBlock(arr, n, descendingOrder);
+        return;
+    }
+
+    // Ascending runs of NETWORK_BLOCK, merged pairwise between two buffers
+    for (int start = 0; start < n; start += NETWORK_BLOCK)
+        networkSortBlock(arr + start, min(NETWORK_BLOCK, n - start), false);
+
+    vector<int> buffer(n);
+    int *from = arr;
+    int *to = buffer.data();
+    for (int width = NETWORK_BLOCK; width < n; width *= 2)
+    {
+        for (int start = 0; start < n; start += 2 * width)
+        {
+            int mid = min(start + width, n);
+            int end = min(start + 2 * width, n);
+            networkKernels.mergeRuns(from + start, mid - start, from + mid, end - mid, to + start);
+        }
+        swap(from, to);
+    }
+    if (from != arr)
+        copy(from, from + n, arr);
+    if (descendingOrder)
+        reverse(arr, arr + n);
+}
+
+// Drop-in replacements for bubbleSort(arr, n, ascending) and bubbleSort(arr, n, descending)
+void networkSortAscending(int arr[], int n)
+{
+    networkSort(arr, n, false);
+}
+
+void networkSortDescending(int arr[], int n)
+{
+    networkSort(arr, n, true);
+}
+
+// LSD radix sort for signed 32/64-bit keys. Each pass scatters by one 8-bit
+// digit, least significant first, so a key costs a few reads and writes per
+// pass instead of log n comparisons. All digit histograms are counted in one
+// read of the input, and a pass whose digit is the same for every key is
+// skipped (small-range keys such as 0..65535 only need 2 of 4 passes).
+const int RADIX_BITS = 8;
+const int RADIX_BUCKETS = 1 << RADIX_BITS;
+// Below this a comparison sort wins; above the second, the scatter is split across threads
+const int RADIX_SMALL_CUTOFF = 256;
+const int RADIX_PARALLEL_CUTOFF = 1 << 21;
+
+// Maps a key to an unsigned one whose unsigned order is the requested order
+template <typename T>
+typename make_unsigned<T>::type radixKey(T value, bool descendingOrder)
+{
+    typedef typename make_unsigned<T>::type Key;
+    Key key = Key(value) ^ (Key(1) << (sizeof(T) * 8 - 1));
+    return descendingOrder ? Key(~key) : key;
+}
+
+template <typename T>
+int radixDigit(T value, int pass, bool descendingOrder)
+{
+    return int((radixKey(value, descendingOrder) >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1));
+}
+
+// Adds the digit counts of every pass for [begin, end) into counts[pass * RADIX_BUCKETS + digit]
+template <typename T>
+void radixCountAll(const T *begin, const T *end, bool descendingOrder, size_t *counts)
+{
+    const int passes = int(sizeof(T));
+    for (const T *p = begin; p != end; ++p)
+    {
+        auto key = radixKey(*p, descendingOrder);
+        for (int pass = 0; pass < passes; pass++)
+            counts[pass * RADIX_BUCKETS + int((key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+    }
+}
+
+// Runs fn(chunk, begin, end) for each of threads equal chunks of [0, n), one thread per chunk
+template <typename Fn>
+void forEachChunk(size_t n, unsigned threads, Fn fn)
+{
+    vector<thread> workers;
+    for (unsigned t = 1; t < threads; t++)
+        workers.emplace_back(fn, t, n * t / threads, n * (t + 1) / threads);
+    fn(0u, size_t(0), n / threads);
+    for (thread &worker : workers)
+        worker.join();
+}
+
+template <typename T>
+void radixSort(T arr[], int n, bool descendingOrder, unsigned threads = 1)
+{
+    static_assert(is_integral<T>::value && is_signed<T>::value && (sizeof(T) == 4 || sizeof(T) == 8),
+                  "radixSort takes signed 32-bit or 64-bit integers");
+    const int passes = int(sizeof(T));
+    if (n <= 1)
+        return;
+    threads = max(1u, min(threads, unsigned(n / RADIX_SMALL_CUTOFF) + 1));
+
+    // Per-chunk histograms of every pass; summed they give the global ones
+    vector<size_t> chunkCounts(size_t(threads) * passes * RADIX_BUCKETS);
+    forEachChunk(n, threads, [&](unsigned chunk, size_t begin, size_t end)
+                 { radixCountAll(arr + begin, arr + end, descendingOrder,
+                                 &chunkCounts[size_t(chunk) * passes * RADIX_BUCKETS]); });
+
+    vector<T> buffer(n);
+    T *from = arr;
+    T *to = buffer.data();
+    bool chunkCountsValid = true;
+    vector<size_t> offsets(size_t(threads) * RADIX_BUCKETS);
+    for (int pass = 0; pass < passes; pass++)
+    {
+        size_t *counts = &chunkCounts[pass * RADIX_BUCKETS];
+        size_t firstDigitTotal = 0;
+        int firstDigit = radixDigit(from[0], pass, descendingOrder);
+        for (unsigned chunk = 0; chunk < threads; chunk++)
+            firstDigitTotal += counts[size_t(chunk) * passes * RADIX_BUCKETS + firstDigit];
+        if (firstDigitTotal == size_t(n))
+            continue;
+
+        // Each scatter moves keys between chunks, so after the first pass that
+        // runs the chunk counts are recounted for the current digit. A single
+        // chunk always holds every key, so its fused counts stay exact.
+        if (!chunkCountsValid)
+        {
+            forEachChunk(n, threads, [&](unsigned chunk, size_t begin, size_t end)
+                         {
+                             size_t *chunkCount = &counts[size_t(chunk) * passes * RADIX_BUCKETS];
+                             fill(chunkCount, chunkCount + RADIX_BUCKETS, size_t(0));
+                             for (size_t i = begin; i < end; i++)
+                                 chunkCount[radixDigit(from[i], pass, descendingOrder)]++; });
+        }
+        chunkCountsValid = threads == 1;
+
+        // Bucket-major, chunk-minor offsets keep the scatter stable
+        size_t next = 0;
+        for (int digit = 0; digit < RADIX_BUCKETS; digit++)
+        {
+            for (unsigned chunk = 0; chunk < threads; chunk++)
+            {
+                offsets[size_t(chunk) * RADIX_BUCKETS + digit] = next;
+                next += counts[size_t(chunk) * passes * RADIX_BUCKETS + digit];
+            }
+        }
+        forEachChunk(n, threads, [&](unsigned chunk, size_t begin, size_t end)
+                     {
+                         size_t *offset = &offsets[size_t(chunk) * RADIX_BUCKETS];
+                         for (size_t i = begin; i < end; i++)
+                             to[offset[radixDigit(from[i], pass, descendingOrder)]++] = from[i]; });
+        swap(from, to);
+    }
+    if (from != arr)
+        copy(from, from + n, arr);
+}
+
+// Radix sort costs one scatter per digit that varies, pdqSort about log n
+// compares per key, so wide keys go to pdqSort. Only the digits up to the
+// highest bit where the smallest and largest keys differ can vary; every key
+// agrees above it. Measured on int64, pdqSort wins once the keys span more
+// than 32 bits (5+ passes over 8-byte keys); at 32 bits the two are level.
+const int RADIX_MAX_PASSES = 4;
+
+enum class SortEngine
+{
+    Comparison,
+    Radix,
+    ParallelRadix
+};
+
+const char *sortEngineName(SortEngine engine)
+{
+    return engine == SortEngine::Comparison ? "pdqSort" : engine == SortEngine::Radix ? "radixSort" : "threaded radixSort";
+}
+
+// Number of 8-bit digits that can differ between keys in arr
+template <typename T>
+int radixVaryingPasses(const T arr[], int n)
+{
+    auto low = radixKey(arr[0], false), high = low;
+    for (int i = 1; i < n; i++)
+    {
+        auto key = radixKey(arr[i], false);
+        low = min(low, key);
+        high = max(high, key);
+    }
+    int passes = 0;
+    for (auto differing = low ^ high; differing; differing >>= RADIX_BITS)
+        passes++;
+    return passes;
+}
+
+// Picks the sort for the input size and key width: a comparison sort for
+// small arrays or keys with too many varying digits, serial radix sort for
+// medium ones and a threaded scatter for large ones
+template <typename T>
+SortEngine chooseSortEngine(const T arr[], int n)
+{
+    if (n < RADIX_SMALL_CUTOFF)
+        return SortEngine::Comparison;
+    // 32-bit keys never need more than 4 passes, so only 64-bit keys pay for the range scan
+    if (sizeof(T) * 8 / RADIX_BITS > RADIX_MAX_PASSES && radixVaryingPasses(arr, n) > RADIX_MAX_PASSES)
+        return SortEngine::Comparison;
+    return n < RADIX_PARALLEL_CUTOFF ? SortEngine::Radix : SortEngine::ParallelRadix;
+}
+
+template <typename T>
+void integerSort(T arr[], int n, bool descendingOrder)
+{
+    SortEngine engine = chooseSortEngine(arr, n);
+    if (engine == SortEngine::Comparison)
+    {
+        if (descendingOrder)
+            pdqSort(arr, n, [](T a, T b)
+                    { return a < b; });
+        else
+            pdqSort(arr, n, [](T a, T b)
+                    { return a > b; });
+    }
+    else if (engine == SortEngine::Radix)
+        radixSort(arr, n, descendingOrder);
+    else
+        radixSort(arr, n, descendingOrder, max(1u, thread::hardware_concurrency()));
+}
+
+void sortingExample()
+{
+    cout << "\n=== Sorting with comparators ===" << endl;
+    int arr1[] = {64, 34, 25, 12, 22, 11, 90};
+    int arr2[] = {64, 34, 25, 12, 22, 11, 90};
+    int n = 7;
+
+    cout << "Original array: ";
+    for (int i = 0; i < n; i++)
+        cout << arr1[i] << " ";
+    cout << endl;
+
+    // Wrapping the function in a lambda gives pdqSort a callee it can inline
+    pdqSort(arr1, n, [](int a, int b)
+            { return ascending(a, b); });
+    cout << "Ascending sort: ";
+    for (int i = 0; i < n; i++)
+        cout << arr1[i] << " ";
+    cout << endl;
+
+    pdqSort(arr2, n, [](int a, int b)
+            { return descending(a, b); });
+    cout << "Descending sort: ";
+    for (int i = 0; i < n; i++)
+        cout << arr2[i] << " ";
+    cout << endl;
+
+    int arr3[] = {64, 34, 25, 12, 22, 11, 90};
+    networkSortDescending(arr3, n);
+    cout << "Descending sort (" << networkKernels.name << " sorting network): ";
+    for (int i = 0; i < n; i++)
+        cout << arr3[i] << " ";
+    cout << endl;
+
+    long long arr4[] = {64, -34, 25, -12, 22, 11, -90};
+    integerSort(arr4, n, false);
+    cout << "Ascending sort (radix, 64-bit keys): ";
+    for (int i = 0; i < n; i++)
+        cout << arr4[i] << " ";
+    cout << endl;
+
+    vector<int> big(1000000);
+    mt19937 rng(1);
+    for (int &value : big)
+        value = int(rng() % 1000000);
+    parallelSort(big.data(), int(big.size()), descending, 4);
+    cout << "Parallel sort of 1000000 ints on 4 threads (descending): "
+         << (is_sorted(big.rbegin(), big.rend()) ? "sorted" : "NOT sorted") << endl;
+}
+
+// Batch evaluation of the calculator operations. Calling operations[i](a, b)
+// once per pair costs an indirect call per element and keeps the compiler
+// from vectorizing; these kernels apply one operation to whole arrays, 8
+// (AVX2) or 4 (SSE2) lanes at a time. Add, subtract and multiply wrap on
+// overflow like the vector instructions do, and divide follows divide()
+// above. Integer division has no vector instruction, so it goes through
+// double, which is exact for 32-bit operands.
+enum class Operation
+{
+    Add,
+    Subtract,
+    Multiply,
+    Divide
+};
+
+// One step of a fused chain: value = value op operand, where the operand is
+// operands[i], or constant when operands is null
+struct ChainStep
+{
+    Operation op;
+    const int *operands;
+    int constant;
+};
+
+typedef void (*BatchFn)(const int *a, const int *b, int *out, int n);
+typedef void (*ChainFn)(const int *first, const ChainStep *steps, int stepCount, int *out, int n);
+
+int applyOperation(Operation op, int a, int b)
+{
+    switch (op)
+    {
+    case Operation::Add:
+        return int(unsigned(a) + unsigned(b));
+    case Operation::Subtract:
+        return int(unsigned(a) - unsigned(b));
+    case Operation::Multiply:
+        return int(unsigned(a) * unsigned(b));
+    default:
+        return divide(a, b);
+    }
+}
+
+int applyChain(int value, const ChainStep *steps, int stepCount, int i)
+{
+    for (int s = 0; s < stepCount; s++)
+        value = applyOperation(steps[s].op, value, steps[s].operands ? steps[s].operands[i] : steps[s].constant);
+    return value;
+}
+
+template <Operation Op>
+void batchScalar(const int *a, const int *b, int *out, int n)
+{
+    for (int i = 0; i < n; i++)
+        out[i] = applyOperation(Op, a[i], b[i]);
+}
+
+void chainScalar(const int *first, const ChainStep *steps, int stepCount, int *out, int n)
+{
+    for (int i = 0; i < n; i++)
+        out[i] = applyChain(first[i], steps, stepCount, i);
+}
+
+#ifdef HAVE_X86_SIMD
+// SSE2 has no 32-bit low multiply, so multiply even and odd lanes as 64-bit and interleave
+__attribute__((target("sse2"))) inline __m128i sse2Mullo(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// Zero divisors are replaced by 1 and their lanes cleared afterwards. The
+// one out-of-range quotient, INT_MIN / -1, converts to INT_MIN
+__attribute__((target("sse2"))) inline __m128i sse2Divide(__m128i a, __m128i b)
+{
+    __m128i zero = _mm_cmpeq_epi32(b, _mm_setzero_si128());
+    b = sse2Select(zero, _mm_set1_epi32(1), b);
+    __m128i low = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(a), _mm_cvtepi32_pd(b)));
+    __m128i high = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2))),
+                                               _mm_cvtepi32_pd(_mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2)))));
+    return _mm_andnot_si128(zero, _mm_unpacklo_epi64(low, high));
+}
+
+__attribute__((target("sse2"))) inline __m128i sse2Apply(Operation op, __m128i a, __m128i b)
+{
+    switch (op)
+    {
+    case Operation::Add:
+        return _mm_add_epi32(a, b);
+    case Operation::Subtract:
+        return _mm_sub_epi32(a, b);
+    case Operation::Multiply:
+        return sse2Mullo(a, b);
+    default:
+        return sse2Divide(a, b);
+    }
+}
+
+template <Operation Op>
+__attribute__((target("sse2"))) void batchSSE2(const int *a, const int *b, int *out, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), sse2Apply(Op, x, y));
+    }
+    for (; i < n; i++)
+        out[i] = applyOperation(Op, a[i], b[i]);
+}
+
+__attribute__((target("sse2"))) void chainSSE2(const int *first, const ChainStep *steps, int stepCount, int *out, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i));
+        for (int s = 0; s < stepCount; s++)
+        {
+            __m128i operand = steps[s].operands
+                                  ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(steps[s].operands + i))
+                                  : _mm_set1_epi32(steps[s].constant);
+            value = sse2Apply(steps[s].op, value, operand);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), value);
+    }
+    for (; i < n; i++)
+        out[i] = applyChain(first[i], steps, stepCount, i);
+}
+
+__attribute__((target("avx2"))) inline __m256i avx2Divide(__m256i a, __m256i b)
+{
+    __m256i zero = _mm256_cmpeq_epi32(b, _mm256_setzero_si256());
+    b = _mm256_blendv_epi8(b, _mm256_set1_epi32(1), zero);
+    __m128i low = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(a)),
+                                                    _mm256_cvtepi32_pd(_mm256_castsi256_si128(b))));
+    __m128i high = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(a, 1)),
+                                                     _mm256_cvtepi32_pd(_mm256_extracti128_si256(b, 1))));
+    return _mm256_andnot_si256(zero, _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1));
+}
+
+__attribute__((target("avx2"))) inline __m256i avx2Apply(Operation op, __m256i a, __m256i b)
+{
+    switch (op)
+    {
+    case Operation::Add:
+        return _mm256_add_epi32(a, b);
+    case Operation::Subtract:
+        return _mm256_sub_epi32(a, b);
+    case Operation::Multiply:
+        return _mm256_mullo_epi32(a, b);
+    default:
+        return avx2Divide(a, b);
+    }
+}
+
+template <Operation Op>
+__attribute__((target("avx2"))) void batchAVX2(const int *a, const int *b, int *out, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), avx2Apply(Op, x, y));
+    }
+    for (; i < n; i++)
+        out[i] = applyOperation(Op, a[i], b[i]);
+}
+
+__attribute__((target("avx2"))) void chainAVX2(const int *first, const ChainStep *steps, int stepCount, int *out, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + i));
+        for (int s = 0; s < stepCount; s++)
+        {
+            __m256i operand = steps[s].operands
+                                  ? _mm256_loadu_si256(reinterpret_cast<const __m256i *>(steps[s].operands + i))
+                                  : _mm256_set1_epi32(steps[s].constant);
+            value = avx2Apply(steps[s].op, value, operand);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), value);
+    }
+    for (; i < n; i++)
+        out[i] = applyChain(first[i], steps, stepCount, i);
+}
+#endif
+
+// Indexed by Operation
+struct OperationKernels
+{
+    BatchFn batch[4];
+    ChainFn chain;
+    const char *name;
+};
+
+OperationKernels selectOperationKernels()
+{
+#ifdef HAVE_X86_SIMD
+    if (__builtin_cpu_supports("avx2"))
+        return {{batchAVX2<Operation::Add>, batchAVX2<Operation::Subtract>,
+                 batchAVX2<Operation::Multiply>, batchAVX2<Operation::Divide>},
+                chainAVX2, "AVX2"};
+    if (__builtin_cpu_supports("sse2"))
+        return {{batchSSE2<Operation::Add>, batchSSE2<Operation::Subtract>,
+                 batchSSE2<Operation::Multiply>, batchSSE2<Operation::Divide>},
+                chainSSE2, "SSE2"};
+#endif
+    return {{batchScalar<Operation::Add>, batchScalar<Operation::Subtract>,
+             batchScalar<Operation::Multiply>, batchScalar<Operation::Divide>},
+            chainScalar, "scalar"};
+}
+
+const OperationKernels operationKernels = selectOperationKernels();
+
+// out[i] = a[i] op b[i]; out may alias a or b
+void applyBatch(Operation op, const int *a, const int *b, int *out, int n)
+{
+    operationKernels.batch[int(op)](a, b, out, n);
+}
+
+// A chain such as ((a + b) * c) / 2 evaluated in one pass: each element stays
+// in a register through every step and only the final value is stored
+class OperationChain
+{
+    const int *first;
+    vector<ChainStep> steps;
+
+public:
+    explicit OperationChain(const int *first) : first(first) {}
+
+    OperationChain &then(Operation op, const int *operands)
+    {
+        steps.push_back({op, operands, 0});
+        return *this;
+    }
+
+    OperationChain &then(Operation op, int constant)
+    {
+        steps.push_back({op, nullptr, constant});
+        return *this;
+    }
+
+    void evaluate(int *out, int n) const
+    {
+        operationKernels.chain(first, steps.data(), int(steps.size()), out, n);
+    }
+};
+
+void batchCalculator()
+{
+    cout << "\n=== Batch calculator (" << operationKernels.name << " kernels) ===" << endl;
+    int a[] = {10, 20, 30, 40, 50, 60, 70, 80, 90, 100};
+    int b[] = {5, 4, 0, -3, 7, 6, 5, 4, 3, 0};
+    int out[10];
+    Operation ops[] = {Operation::Add, Operation::Subtract, Operation::Multiply, Operation::Divide};
+    string names[] = {"Add", "Subtract", "Multiply", "Divide"};
+    for (int i = 0; i < 4; i++)
+    {
+        applyBatch(ops[i], a, b, out, 10);
+        cout << names[i] << ": ";
+        for (int value : out)
+            cout << value << " ";
+        cout << endl;
+    }
+
+    OperationChain(a).then(Operation::Add, b).then(Operation::Multiply, 3).then(Operation::Divide, b).evaluate(out, 10);
+    cout << "(a + b) * 3 / b, fused: ";
+    for (int value : out)
+        cout << value << " ";
+    cout << endl;
+}
+
+// Two lighter alternatives to std::function for dispatch tables. std::function
+// may heap-allocate when a capture is too big for its small buffer, and every
+// copy copies the target. function_ref is a non-owning view: a pointer to
+// the callable and a trampoline, so it must not outlive what it refers to.
+// inplace_function owns its callable but keeps it in a fixed inline buffer;
+// a callable that does not fit is a compile error rather than an allocation.
+template <typename Signature>
+class function_ref;
+
+template <typename R, typename... Args>
+class function_ref<R(Args...)>
+{
+    union
+    {
+        void *object;
+        R (*function)(Args...);
+    } target;
+    R (*invoker)(decltype(target), Args...);
+
+public:
+    function_ref(R (*function)(Args...))
+    {
+        target.function = function;
+        invoker = [](decltype(target) t, Args... args) -> R
+        { return t.function(forward<Args>(args)...); };
+    }
+
+    // Captureless lambdas and functions are stored as plain function pointers,
+    // so a temporary lambda argument does not leave a dangling reference
+    template <typename F, typename = typename enable_if<
+                              !is_same<typename decay<F>::type, function_ref>::value>::type>
+    function_ref(F &&callable)
+    {
+        if constexpr (is_convertible<F, R (*)(Args...)>::value)
+        {
+            target.function = static_cast<R (*)(Args...)>(callable);
+            invoker = [](decltype(target) t, Args... args) -> R
+            { return t.function(forward<Args>(args)...); };
+        }
+        else
+        {
+            target.object = const_cast<void *>(static_cast<const void *>(addressof(callable)));
+            invoker = [](decltype(target) t, Args... args) -> R
+            { return (*static_cast<typename remove_reference<F>::type *>(t.object))(forward<Args>(args)...); };
+        }
+    }
+
+    R operator()(Args... args) const
+    {
+        return invoker(target, forward<Args>(args)...);
+    }
+};
+
+template <typename Signature, size_t Capacity = 32>
+class inplace_function;
+
+template <typename R, typename... Args, size_t Capacity>
+class inplace_function<R(Args...), Capacity>
+{
+    enum class Action
+    {
+        Copy,
+        Move,
+        Destroy
+    };
+
+    alignas(max_align_t) unsigned char storage[Capacity];
+    R (*invoker)(void *, Args...) = nullptr;
+    // Copies or moves the callable in source into destination, or destroys destination
+    void (*manager)(Action, void *destination, void *source) = nullptr;
+
+    void assignFrom(const inplace_function &other, Action action)
+    {
+        if (other.manager)
+            other.manager(action, storage, const_cast<unsigned char *>(other.storage));
+        invoker = other.invoker;
+        manager = other.manager;
+    }
+
+    void reset()
+    {
+        if (manager)
+            manager(Action::Destroy, storage, nullptr);
+        invoker = nullptr;
+        manager = nullptr;
+    }
+
+public:
+    inplace_function() = default;
+
+    template <typename F, typename = typename enable_if<
+                              !is_same<typename decay<F>::type, inplace_function>::value>::type>
+    inplace_function(F &&callable)
+    {
+        typedef typename decay<F>::type Target;
+        static_assert(sizeof(Target) <= Capacity, "callable does not fit in inplace_function; raise Capacity");
+        static_assert(alignof(Target) <= alignof(max_align_t), "callable is over-aligned for inplace_function");
+        static_assert(is_nothrow_move_constructible<Target>::value,
+                      "inplace_function needs a callable whose move constructor cannot throw");
+        new (storage) Target(forward<F>(callable));
+        invoker = [](void *object, Args... args) -> R
+        { return (*static_cast<Target *>(object))(forward<Args>(args)...); };
+        manager = [](Action action, void *destination, void *source)
+        {
+            if (action == Action::Copy)
+                new (destination) Target(*static_cast<const Target *>(source));
+            else if (action == Action::Move)
+                new (destination) Target(move(*static_cast<Target *>(source)));
+            else
+                static_cast<Target *>(destination)->~Target();
+        };
+    }
+
+    inplace_function(const inplace_function &other) { assignFrom(other, Action::Copy); }
+    inplace_function(inplace_function &&other) noexcept { assignFrom(other, Action::Move); }
+
+    inplace_function &operator=(const inplace_function &other)
+    {
+        if (this != &other)
+        {
+            reset();
+            assignFrom(other, Action::Copy);
+        }
+        return *this;
+    }
+
+    inplace_function &operator=(inplace_function &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            assignFrom(other, Action::Move);
+        }
+        return *this;
+    }
+
+    ~inplace_function() { reset(); }
+
+    explicit operator bool() const { return invoker != nullptr; }
+
+    R operator()(Args... args) const
+    {
+        if (!invoker)
+            throw bad_function_call();
+        return invoker(const_cast<unsigned char *>(storage), forward<Args>(args)...);
+    }
+};
+
+// Takes any callable without copying it or allocating, e.g. a lambda argument
+int useIt(function_ref<int(int, int)> operation, int a, int b)
+{
+    return operation(a, b);
+}
+
+// Works with any table whose entries are callable as int(int, int)
+template <typename Table>
+void printDispatchTable(const Table &operations, const vector<string> &names, int a, int b)
+{
+    for (size_t i = 0; i < operations.size(); i++)
+    {
+        cout << names[i] << ": " << operations[i](a, b) << endl;
+    }
+}
+
+// Modern approach with std::function
+void modernApproach()
+{
+    cout << "\n=== Modern approach with std::function ===" << endl;
+
+    vector<function<int(int, int)>> operations = {
+        [](int a, int b)
+        { return a + b; },
+        [](int a, int b)
+        { return a - b; },
+        [](int a, int b)
+        { return a * b; },
+        [](int a, int b)
+        { return a / b; }};
+
+    vector<string> names = {"Add", "Subtract", "Multiply", "Divide"};
+
+    int a = 20, b = 4;
+
+    printDispatchTable(operations, names, a, b);
+
+    // The same table without std::function; the capture lives in the inline buffer
+    int offset = 100;
+    vector<inplace_function<int(int, int)>> inplaceOperations = {
+        add, subtract, multiply, [offset](int x, int y)
+        { return divide(x, y) + offset; }};
+    cout << "\n=== Same table with inplace_function (Divide adds " << offset << ") ===" << endl;
+    printDispatchTable(inplaceOperations, names, a, b);
+
+    // function_ref only points at the entries, which must outlive the table
+    vector<function_ref<int(int, int)>> refOperations(operations.begin(), operations.end());
+    cout << "\n=== Same table with function_ref ===" << endl;
+    printDispatchTable(refOperations, names, a, b);
+}
+
+// Benchmarks: build with optimizations for meaningful numbers, e.g.
+//   g++ -std=c++17 -O2 -o 08-function-pointers 08-function-pointers.cpp && ./08-function-pointers --bench
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+vector<int> randomInts(size_t n, unsigned seed)
+{
+    vector<int> values(n);
+    mt19937 rng(seed);
+    for (int &value : values)
+        value = int(rng());
+    return values;
+}
+
+int compareIntsForQsort(const void *a, const void *b)
+{
+    int x = *static_cast<const int *>(a);
+    int y = *static_cast<const int *>(b);
+    return (x > y) - (x < y);
+}
+
+// Times one sort of a fresh copy of input and checks the result
+template <typename Sort>
+void timeSort(const string &name, const vector<int> &input, const vector<int> &expected, Sort sortFn)
+{
+    vector<int> data(input);
+    auto start = chrono::steady_clock::now();
+    sortFn(data.data(), int(data.size()));
+    double ms = elapsedMs(start);
+    cout << "    " << name << ": " << ms << " ms" << (data == expected ? "" : " (WRONG ORDER)") << endl;
+}
+
+// bubbleSort is O(n^2), so it only runs on the small sizes
+void benchmarkSorts(int maxN)
+{
+    cout << "=== Sorting random ints ===" << endl;
+    for (int n = 1000; n <= maxN; n *= 10)
+    {
+        vector<int> input = randomInts(n, n);
+        vector<int> expected(input);
+        sort(expected.begin(), expected.end());
+
+        cout << "  n = " << n << endl;
+        if (n <= 10000)
+            timeSort("bubbleSort (function pointer)", input, expected, [](int *a, int size)
+                     { bubbleSort(a, size, ascending); });
+        timeSort("qsort", input, expected, [](int *a, int size)
+                 { qsort(a, size, sizeof(int), compareIntsForQsort); });
+        timeSort("std::sort", input, expected, [](int *a, int size)
+                 { sort(a, a + size); });
+        timeSort("pdqSort (function pointer)", input, expected, [](int *a, int size)
+                 { pdqSort(a, size, ascending); });
+        timeSort("pdqSort (lambda)", input, expected, [](int *a, int size)
+                 { pdqSort(a, size, [](int x, int y)
+                           { return x > y; }); });
+    }
+}
+
+void benchmarkParallelSort(int n)
+{
+    vector<int> input = randomInts(n, 99);
+    vector<int> expected(input);
+    sort(expected.begin(), expected.end());
+
+    cout << "=== Parallel merge sort on a work-stealing pool (" << n << " ints) ===" << endl;
+    double baseMs = 0;
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+    for (unsigned threads = 1;; threads = min(threads * 2, maxThreads))
+    {
+        WorkStealingPool pool(threads);
+        vector<int> data(input);
+        auto start = chrono::steady_clock::now();
+        parallelSort(data.data(), n, ascending, pool);
+        double ms = elapsedMs(start);
+        if (threads == 1)
+            baseMs = ms;
+        cout << "  " << threads << " thread(s): " << ms << " ms, speedup " << baseMs / ms << "x"
+             << (data == expected ? "" : " (WRONG ORDER)") << endl;
+        if (threads == maxThreads)
+            break;
+    }
+}
+
+// Sorts many independent small batches, the case the network is built for
+void benchmarkNetwork(int total)
+{
+    cout << "=== Small-batch sorting, " << networkKernels.name << " network (ns per element) ===" << endl;
+    for (int batch = 8; batch <= 4096; batch *= 2)
+    {
+        int batches = max(1, total / batch);
+        vector<int> input = randomInts(size_t(batches) * batch, batch);
+        vector<int> expected(input);
+        for (int b = 0; b < batches; b++)
+            sort(expected.begin() + size_t(b) * batch, expected.begin() + size_t(b + 1) * batch);
+
+        auto timeBatches = [&](void (*sortBatch)(int *, int))
+        {
+            vector<int> data(input);
+            auto start = chrono::steady_clock::now();
+            for (int b = 0; b < batches; b++)
+                sortBatch(data.data() + size_t(b) * batch, batch);
+            double ns = elapsedMs(start) * 1e6 / data.size();
+            return data == expected ? ns : -1.0;
+        };
+
+        cout << "  batch " << batch << ": std::sort " << timeBatches([](int *a, int n)
+                                                                    { sort(a, a + n); })
+             << ", pdqSort " << timeBatches([](int *a, int n)
+                                           { pdqSort(a, n, [](int x, int y)
+                                                     { return x > y; }); })
+             << ", networkSort " << timeBatches(networkSortAscending);
+        if (batch <= 256)
+            cout << ", bubbleSort " << timeBatches([](int *a, int n)
+                                                   { bubbleSort(a, n, ascending); });
+        cout << endl;
+    }
+}
+
+// Radix sort against the comparison sorts, on full-range and small-range keys
+template <typename T>
+void benchmarkRadixFor(const string &typeName, int maxN)
+{
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    for (int range = 0; range < 2; range++)
+    {
+        cout << "  " << typeName << (range ? " keys in [0, 65536)" : " keys, full range") << endl;
+        for (int n = 1000; n <= maxN; n *= 10)
+        {
+            vector<T> input(n);
+            mt19937_64 rng(n);
+            for (T &value : input)
+                value = range ? T(rng() % 65536) : T(rng());
+            vector<T> expected(input);
+            sort(expected.begin(), expected.end());
+
+            auto timeIt = [&](void (*sortFn)(T *, int))
+            {
+                vector<T> data(input);
+                auto start = chrono::steady_clock::now();
+                sortFn(data.data(), n);
+                double ms = elapsedMs(start);
+                return data == expected ? ms : -1.0;
+            };
+            cout << "    n = " << n << ": std::sort " << timeIt([](T *a, int size)
+                                                              { sort(a, a + size); })
+                 << " ms, pdqSort " << timeIt([](T *a, int size)
+                                              { pdqSort(a, size, [](T x, T y)
+                                                        { return x > y; }); })
+                 << " ms, radixSort " << timeIt([](T *a, int size)
+                                                { radixSort(a, size, false); })
+                 << " ms, integerSort " << timeIt([](T *a, int size)
+                                                  { integerSort(a, size, false); })
+                 << " ms (" << sortEngineName(chooseSortEngine(input.data(), n)) << ", " << threads
+                 << " hardware thread(s))" << endl;
+        }
+    }
+}
+
+void benchmarkRadix(int maxN)
+{
+    cout << "=== Radix sort vs comparison sorts ===" << endl;
+    benchmarkRadixFor<int32_t>("int32", maxN);
+    benchmarkRadixFor<int64_t>("int64", maxN);
+}
+
+// Per-element std::function calls, as in modernApproach(), against the batch
+// kernels, for single operations and for the chain (a + b) * c / d
+void benchmarkBatch(int n)
+{
+    vector<int> a = randomInts(n, 1), b = randomInts(n, 2), c = randomInts(n, 3), d = randomInts(n, 4);
+    for (int i = 0; i < n; i += 16)
+        d[i] = 0;
+    vector<int> out(n), expected(n);
+
+    // Random ints overflow add and multiply, so the per-element calls use the wrapping versions
+    vector<function<int(int, int)>> operations;
+    for (int op = 0; op < 4; op++)
+        operations.push_back([op](int x, int y)
+                             { return applyOperation(Operation(op), x, y); });
+    string names[] = {"add", "subtract", "multiply", "divide"};
+
+    cout << "=== Batch operations on " << n << " pairs, " << operationKernels.name << " kernels (ms) ===" << endl;
+    for (int op = 0; op < 4; op++)
+    {
+        for (int i = 0; i < n; i++)
+            expected[i] = applyOperation(Operation(op), a[i], d[i]);
+
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < n; i++)
+            out[i] = operations[op](a[i], d[i]);
+        double functionMs = elapsedMs(start);
+        bool ok = out == expected;
+
+        start = chrono::steady_clock::now();
+        applyBatch(Operation(op), a.data(), d.data(), out.data(), n);
+        double batchMs = elapsedMs(start);
+        ok = ok && out == expected;
+
+        cout << "  " << names[op] << ": std::function " << functionMs << ", applyBatch " << batchMs
+             << (ok ? "" : " (MISMATCH)") << endl;
+    }
+
+    ChainStep steps[] = {{Operation::Add, b.data(), 0}, {Operation::Multiply, c.data(), 0}, {Operation::Divide, d.data(), 0}};
+    for (int i = 0; i < n; i++)
+        expected[i] = applyChain(a[i], steps, 3, i);
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+        out[i] = operations[3](operations[2](operations[0](a[i], b[i]), c[i]), d[i]);
+    double functionMs = elapsedMs(start);
+    bool ok = out == expected;
+
+    vector<int> sum(n), product(n);
+    start = chrono::steady_clock::now();
+    applyBatch(Operation::Add, a.data(), b.data(), sum.data(), n);
+    applyBatch(Operation::Multiply, sum.data(), c.data(), product.data(), n);
+    applyBatch(Operation::Divide, product.data(), d.data(), out.data(), n);
+    double unfusedMs = elapsedMs(start);
+    ok = ok && out == expected;
+
+    start = chrono::steady_clock::now();
+    OperationChain(a.data())
+        .then(Operation::Add, b.data())
+        .then(Operation::Multiply, c.data())
+        .then(Operation::Divide, d.data())
+        .evaluate(out.data(), n);
+    double fusedMs = elapsedMs(start);
+    ok = ok && out == expected;
+
+    cout << "  (a + b) * c / d: std::function " << functionMs << ", applyBatch x3 " << unfusedMs
+         << ", OperationChain " << fusedMs << (ok ? "" : " (MISMATCH)") << endl;
+}
+
+// Call overhead of each kind of dispatch table entry. The index changes on
+// every call, so the compiler cannot resolve the target ahead of time
+struct AddVisitor
+{
+    int operator()(int a, int b) const { return a + b; }
+};
+struct SubtractVisitor
+{
+    int operator()(int a, int b) const { return a - b; }
+};
+struct MultiplyVisitor
+{
+    int operator()(int a, int b) const { return a * b; }
+};
+struct DivideVisitor
+{
+    int operator()(int a, int b) const { return divide(a, b); }
+};
+typedef variant<AddVisitor, SubtractVisitor, MultiplyVisitor, DivideVisitor> OperationVariant;
+
+template <typename Call>
+void timeCalls(const string &name, int n, Call call)
+{
+    auto start = chrono::steady_clock::now();
+    unsigned checksum = 0;
+    for (int i = 0; i < n; i++)
+        checksum = checksum * 31 + unsigned(call(i & 3, i & 1023, ((i >> 10) & 63) - 31));
+    double ms = elapsedMs(start);
+    cout << "  " << name << ": " << ms * 1e6 / n << " ns/call (checksum " << checksum << ")" << endl;
+}
+
+void benchmarkCallables(int n)
+{
+    // The wrappers hold the visitor objects themselves, so each has exactly one indirect call
+    int (*pointers[4])(int, int) = {add, subtract, multiply, divide};
+    AddVisitor addOp;
+    SubtractVisitor subtractOp;
+    MultiplyVisitor multiplyOp;
+    DivideVisitor divideOp;
+    vector<function<int(int, int)>> functions = {addOp, subtractOp, multiplyOp, divideOp};
+    vector<inplace_function<int(int, int)>> inplace = {addOp, subtractOp, multiplyOp, divideOp};
+    vector<function_ref<int(int, int)>> refs = {addOp, subtractOp, multiplyOp, divideOp};
+    vector<OperationVariant> variants = {addOp, subtractOp, multiplyOp, divideOp};
+
+    cout << "=== Dispatch table call overhead, " << n << " calls ===" << endl;
+    timeCalls("function pointer", n, [&](int op, int a, int b)
+              { return pointers[op](a, b); });
+    timeCalls("std::function", n, [&](int op, int a, int b)
+              { return functions[op](a, b); });
+    timeCalls("inplace_function", n, [&](int op, int a, int b)
+              { return inplace[op](a, b); });
+    timeCalls("function_ref", n, [&](int op, int a, int b)
+              { return refs[op](a, b); });
+    timeCalls("std::variant + visit", n, [&](int op, int a, int b)
+              { return visit([a, b](const auto &operation)
+                             { return operation(a, b); },
+                             variants[op]); });
+}
+
+// Usage: --bench [name] [n], where name is one of: all, sort, parallel, network, radix, batch, callable
+int runBenchmarks(const string &which, int n)
+{
+    bool all = which == "all";
+    bool known = false;
+    if (all || which == "sort")
+    {
+        // Pass 100000000 to go up to 100M elements (~1.2 GB)
+        benchmarkSorts(n ? n : 10000000);
+        known = true;
+    }
+    if (all || which == "parallel")
+    {
+        benchmarkParallelSort(n ? n : 50000000);
+        known = true;
+    }
+    if (all || which == "network")
+    {
+        benchmarkNetwork(n ? n : 4000000);
+        known = true;
+    }
+    if (all || which == "radix")
+    {
+        benchmarkRadix(n ? n : 10000000);
+        known = true;
+    }
+    if (all || which == "batch")
+    {
+        benchmarkBatch(n ? n : 10000000);
+        known = true;
+    }
+    if (all || which == "callable")
+    {
+        benchmarkCallables(n ? n : 100000000);
+        known = true;
+    }
+    if (!known)
+    {
+        cout << "Unknown benchmark: " << which << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--bench")
+        return runBenchmarks(argc > 2 ? argv[2] : "all", argc > 3 ? atoi(argv[3]) : 0);
+
     cout << "=== Basic Function Pointers ===" << endl;
     apply_and_print(add_one, 5);   // prints 6
     apply_and_print(times_two, 5); // prints 10
@@ -114,6 +2083,11 @@ int main()
     calculator();
     sortingExample();
     modernApproach();
+    cout << "function_ref parameter from a lambda: " << useIt([](int a, int b)
+                                                              { return a % b; },
+                                                              20, 7)
+         << endl;
+    batchCalculator();
 
     return 0;
 }
\ No newline at end of file
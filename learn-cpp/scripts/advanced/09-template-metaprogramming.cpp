@@ -1,4 +1,24 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <numeric>
 #include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
 using namespace std;
 
 // Template metaprogramming factorial
@@ -80,6 +100,180 @@ constexpr int constexpr_power_of_2(int n)
     return (n == 0) ? 1 : 2 * constexpr_power_of_2(n - 1);
 }
 
+// Compile-time lookup tables. The structs above instantiate one template per
+// value and each gives a single int constant; a constexpr generator fills a
+// whole std::array in one evaluation, so runtime code can index it with a
+// value of n that is only known at runtime. The checked arithmetic throws
+// on overflow, and a throw is not allowed in a constant expression, so a
+// table too long for its type fails to compile instead of wrapping.
+typedef unsigned __int128 uint128_t;
+
+template <typename T>
+constexpr T max_unsigned() { return T(~T(0)); }
+
+template <typename T>
+constexpr T checked_add(T a, T b)
+{
+    return a > max_unsigned<T>() - b ? throw overflow_error("table value overflows its type") : a + b;
+}
+
+template <typename T>
+constexpr T checked_mul(T a, T b)
+{
+    return b != 0 && a > max_unsigned<T>() / b ? throw overflow_error("table value overflows its type") : a * b;
+}
+
+// table[i] = generate(i) for i in [0, N)
+template <typename T, size_t N, typename Generator>
+constexpr array<T, N> make_table(Generator generate)
+{
+    array<T, N> table{};
+    for (size_t i = 0; i < N; i++)
+        table[i] = generate(i);
+    return table;
+}
+
+// 0! .. (N-1)!; 21 entries fit uint64_t, 35 fit uint128_t
+template <typename T, size_t N>
+constexpr array<T, N> factorial_table()
+{
+    array<T, N> table{};
+    T value = 1;
+    for (size_t i = 0; i < N; i++)
+    {
+        value = i ? checked_mul(value, T(i)) : 1;
+        table[i] = value;
+    }
+    return table;
+}
+
+// Base^0 .. Base^(N-1)
+template <typename T, unsigned Base, size_t N>
+constexpr array<T, N> power_table()
+{
+    array<T, N> table{};
+    for (size_t i = 0; i < N; i++)
+        table[i] = i ? checked_mul(table[i - 1], T(Base)) : 1;
+    return table;
+}
+
+// fib(0) .. fib(N-1); 94 entries fit uint64_t, 187 fit uint128_t
+template <typename T, size_t N>
+constexpr array<T, N> fibonacci_table()
+{
+    array<T, N> table{};
+    for (size_t i = 0; i < N; i++)
+        table[i] = i < 2 ? T(i) : checked_add(table[i - 1], table[i - 2]);
+    return table;
+}
+
+// Pascal's triangle: table[n][k] = C(n, k) for n < N, zero above the diagonal;
+// 68 rows fit uint64_t
+template <typename T, size_t N>
+constexpr array<array<T, N>, N> binomial_table()
+{
+    array<array<T, N>, N> table{};
+    for (size_t n = 0; n < N; n++)
+    {
+        table[n][0] = 1;
+        for (size_t k = 1; k <= n; k++)
+            table[n][k] = checked_add(table[n - 1][k - 1], table[n - 1][k]);
+    }
+    return table;
+}
+
+constexpr auto factorials = factorial_table<uint64_t, 21>();
+constexpr auto factorials_wide = factorial_table<uint128_t, 35>();
+constexpr auto powers_of_2 = power_table<uint64_t, 2, 64>();
+constexpr auto powers_of_10 = power_table<uint64_t, 10, 20>();
+constexpr auto fibonaccis = fibonacci_table<uint64_t, 94>();
+constexpr auto fibonaccis_wide = fibonacci_table<uint128_t, 187>();
+constexpr auto binomials = binomial_table<uint64_t, 68>();
+constexpr auto squares = make_table<uint32_t, 256>([](size_t i)
+                                                   { return uint32_t(i * i); });
+
+static_assert(factorials[20] == 2432902008176640000ull, "20! is the last factorial in 64 bits");
+static_assert(fibonaccis[93] == 12200160415121876738ull, "fib(93) is the last Fibonacci number in 64 bits");
+static_assert(binomials[67][33] == 14226520737620288370ull, "C(67, 33) is the widest binomial in 64 bits");
+// One more entry does not compile, e.g.
+//   constexpr auto too_long = factorial_table<uint64_t, 22>();  // error: throw in constant expression
+
+string to_string_u128(uint128_t value)
+{
+    string digits;
+    do
+    {
+        digits.insert(digits.begin(), char('0' + int(value % 10)));
+        value /= 10;
+    } while (value);
+    return digits;
+}
+
+// The enum approach laid out as a table: one factorial<I> instantiation per entry
+template <size_t... I>
+constexpr array<uint64_t, sizeof...(I)> enum_factorial_table(index_sequence<I...>)
+{
+    return {{uint64_t(factorial<I>::value)...}};
+}
+
+// Compile-time cost: build a 64-row Pascal triangle either way and time the
+// compiler, e.g.
+//   time g++ -std=c++17 -fsyntax-only -DTABLE_COST_ENUM 09-template-metaprogramming.cpp
+//   time g++ -std=c++17 -fsyntax-only -DTABLE_COST_CONSTEXPR 09-template-metaprogramming.cpp
+// against a plain -fsyntax-only run as the baseline
+#if defined(TABLE_COST_ENUM)
+template <unsigned n, unsigned k>
+struct binomial
+{
+    enum : uint64_t
+    {
+        value = binomial<n - 1, k - 1>::value + binomial<n - 1, k>::value
+    };
+};
+template <unsigned n>
+struct binomial<n, 0>
+{
+    enum : uint64_t
+    {
+        value = 1
+    };
+};
+template <unsigned n>
+struct binomial<n, n>
+{
+    enum : uint64_t
+    {
+        value = 1
+    };
+};
+template <>
+struct binomial<0, 0>
+{
+    enum : uint64_t
+    {
+        value = 1
+    };
+};
+
+template <size_t n, size_t... k>
+constexpr array<uint64_t, 64> enum_binomial_row(index_sequence<k...>)
+{
+    return {{(k <= n ? uint64_t(binomial<unsigned(n), unsigned(k <= n ? k : 0)>::value) : 0)...}};
+}
+
+template <size_t... n>
+constexpr array<array<uint64_t, 64>, 64> enum_binomial_table(index_sequence<n...>)
+{
+    return {{enum_binomial_row<n>(make_index_sequence<64>())...}};
+}
+
+constexpr auto cost_table = enum_binomial_table(make_index_sequence<64>());
+static_assert(cost_table[63][31] == 916312070471295267ull, "enum binomials");
+#elif defined(TABLE_COST_CONSTEXPR)
+constexpr auto cost_table = binomial_table<uint64_t, 64>();
+static_assert(cost_table[63][31] == 916312070471295267ull, "constexpr binomials");
+#endif
+
 // Template function for type-generic operations
 template <typename T>
 T max_value(T a, T b)
@@ -98,8 +292,865 @@ void print_array(T (&arr)[size])
     cout << endl;
 }
 
-int main()
+// Expression templates: a + b * c on these arrays builds a small tree of
+// types describing the computation instead of computing anything. Only
+// assigning the tree to an Array runs it, as one loop in which element i of
+// every operand is combined in registers, so there is no temporary array per
+// operator and the compiler can vectorize the loop. Sizes known at compile
+// time (Extent) are checked by static_assert; dynamic ones at assignment.
+const size_t DYNAMIC_EXTENT = size_t(-1);
+
+template <typename E>
+struct ArrayExpr
+{
+    const E &self() const { return static_cast<const E &>(*this); }
+    size_t size() const { return self().size(); }
+    auto operator[](size_t i) const { return self()[i]; }
+};
+
+template <typename T, size_t Extent = DYNAMIC_EXTENT>
+class Array;
+
+// Read-only view of contiguous elements: a built-in array (the T (&arr)[size]
+// pattern of print_array) or an Array. Expressions hold arrays through views,
+// so the loop reads from a plain pointer it can keep in a register.
+template <typename T, size_t N>
+class ArrayView : public ArrayExpr<ArrayView<T, N>>
+{
+    const T *data;
+    size_t count;
+
+public:
+    static constexpr size_t extent = N;
+    template <size_t M>
+    explicit ArrayView(const T (&arr)[M]) : data(arr), count(M)
+    {
+        static_assert(M == N, "array extents differ");
+    }
+    ArrayView(const Array<T, N> &arr) : data(arr.begin()), count(arr.size()) {}
+    size_t size() const { return count; }
+    T operator[](size_t i) const { return data[i]; }
+};
+
+template <typename T, size_t N>
+ArrayView<T, N> view(const T (&arr)[N])
+{
+    return ArrayView<T, N>(arr);
+}
+
+// A scalar broadcast to every index, so a * 2.0 is an expression too
+template <typename T>
+class ScalarExpr : public ArrayExpr<ScalarExpr<T>>
 {
+    T value;
+
+public:
+    static constexpr size_t extent = DYNAMIC_EXTENT;
+    explicit ScalarExpr(T value) : value(value) {}
+    size_t size() const { return 0; }
+    T operator[](size_t) const { return value; }
+};
+
+// Operands are held by value: arrays through a view, expression nodes
+// directly; both only point at array storage, so a tree built in one
+// statement stays valid while the arrays it names do
+template <typename E>
+struct expr_operand
+{
+    typedef E type;
+};
+
+template <typename T, size_t Extent>
+struct expr_operand<Array<T, Extent>>
+{
+    typedef ArrayView<T, Extent> type;
+};
+
+template <typename Op, typename L, typename R>
+class BinaryExpr : public ArrayExpr<BinaryExpr<Op, L, R>>
+{
+    typename expr_operand<L>::type left;
+    typename expr_operand<R>::type right;
+
+public:
+    static_assert(L::extent == DYNAMIC_EXTENT || R::extent == DYNAMIC_EXTENT || L::extent == R::extent,
+                  "array extents differ");
+    static constexpr size_t extent = L::extent != DYNAMIC_EXTENT ? L::extent : R::extent;
+
+    BinaryExpr(const L &left, const R &right) : left(left), right(right) {}
+
+    // A scalar operand reports size 0 and takes the size of the other side
+    size_t size() const
+    {
+        if (left.size() && right.size() && left.size() != right.size())
+            throw length_error("array sizes differ");
+        return left.size() ? left.size() : right.size();
+    }
+
+    auto operator[](size_t i) const { return Op::apply(left[i], right[i]); }
+};
+
+struct AddOp
+{
+    template <typename A, typename B>
+    static auto apply(A a, B b) { return a + b; }
+};
+struct SubtractOp
+{
+    template <typename A, typename B>
+    static auto apply(A a, B b) { return a - b; }
+};
+struct MultiplyOp
+{
+    template <typename A, typename B>
+    static auto apply(A a, B b) { return a * b; }
+};
+struct DivideOp
+{
+    template <typename A, typename B>
+    static auto apply(A a, B b) { return a / b; }
+};
+
+// Fixed extent stores the elements inline like std::array; DYNAMIC_EXTENT
+// stores them in a vector sized at construction
+template <typename T, size_t Extent>
+class Array : public ArrayExpr<Array<T, Extent>>
+{
+    typename conditional<Extent == DYNAMIC_EXTENT, vector<T>, array<T, Extent>>::type elements;
+
+    template <typename E>
+    void assign(const ArrayExpr<E> &expr)
+    {
+        // A local copy (a few pointers) so the loop knows its stores cannot change the operands' pointers
+        const E e = expr.self();
+        if (e.size() != size())
+            throw length_error("array sizes differ");
+        T *out = elements.data();
+        size_t n = size();
+        // Element i only reads index i of each operand, so writing into an
+        // operand (a = a * b) carries no dependence between iterations
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC ivdep
+#endif
+        for (size_t i = 0; i < n; i++)
+            out[i] = e[i];
+    }
+
+public:
+    static constexpr size_t extent = Extent;
+
+    template <size_t E = Extent, typename = typename enable_if<E != DYNAMIC_EXTENT>::type>
+    Array() : elements{} {}
+
+    template <size_t E = Extent, typename = typename enable_if<E == DYNAMIC_EXTENT>::type>
+    explicit Array(size_t n, T value = T()) : elements(n, value) {}
+
+    template <size_t N>
+    explicit Array(const T (&arr)[N])
+    {
+        static_assert(Extent == DYNAMIC_EXTENT || Extent == N, "array extents differ");
+        resize_for(N);
+        copy(arr, arr + N, elements.data());
+    }
+
+    // Evaluates an expression into a new array
+    template <typename E>
+    Array(const ArrayExpr<E> &expr)
+    {
+        static_assert(Extent == DYNAMIC_EXTENT || E::extent == DYNAMIC_EXTENT || E::extent == Extent,
+                      "array extents differ");
+        resize_for(expr.size());
+        assign(expr);
+    }
+
+    template <typename E>
+    Array &operator=(const ArrayExpr<E> &expr)
+    {
+        static_assert(Extent == DYNAMIC_EXTENT || E::extent == DYNAMIC_EXTENT || E::extent == Extent,
+                      "array extents differ");
+        assign(expr);
+        return *this;
+    }
+
+    size_t size() const { return elements.size(); }
+    T operator[](size_t i) const { return elements[i]; }
+    T &operator[](size_t i) { return elements[i]; }
+    T *begin() { return elements.data(); }
+    T *end() { return elements.data() + size(); }
+    const T *begin() const { return elements.data(); }
+    const T *end() const { return elements.data() + size(); }
+
+private:
+    template <size_t E = Extent>
+    typename enable_if<E == DYNAMIC_EXTENT>::type resize_for(size_t n) { elements.resize(n); }
+    template <size_t E = Extent>
+    typename enable_if<E != DYNAMIC_EXTENT>::type resize_for(size_t) {}
+};
+
+// Operators for expression op expression and for either side being a scalar
+template <typename T>
+struct is_array_scalar : integral_constant<bool, is_arithmetic<T>::value>
+{
+};
+
+#define ARRAY_EXPR_OPERATOR(symbol, Op)                                                         \
+    template <typename L, typename R>                                                           \
+    BinaryExpr<Op, L, R> operator symbol(const ArrayExpr<L> &left, const ArrayExpr<R> &right)   \
+    {                                                                                           \
+        return BinaryExpr<Op, L, R>(left.self(), right.self());                                 \
+    }                                                                                           \
+    template <typename L, typename S, typename = typename enable_if<is_array_scalar<S>::value>::type> \
+    BinaryExpr<Op, L, ScalarExpr<S>> operator symbol(const ArrayExpr<L> &left, S right)         \
+    {                                                                                           \
+        return BinaryExpr<Op, L, ScalarExpr<S>>(left.self(), ScalarExpr<S>(right));             \
+    }                                                                                           \
+    template <typename S, typename R, typename = typename enable_if<is_array_scalar<S>::value>::type> \
+    BinaryExpr<Op, ScalarExpr<S>, R> operator symbol(S left, const ArrayExpr<R> &right)         \
+    {                                                                                           \
+        return BinaryExpr<Op, ScalarExpr<S>, R>(ScalarExpr<S>(left), right.self());             \
+    }
+
+ARRAY_EXPR_OPERATOR(+, AddOp)
+ARRAY_EXPR_OPERATOR(-, SubtractOp)
+ARRAY_EXPR_OPERATOR(*, MultiplyOp)
+ARRAY_EXPR_OPERATOR(/, DivideOp)
+#undef ARRAY_EXPR_OPERATOR
+
+template <typename T, size_t Extent>
+void print_array(const Array<T, Extent> &arr)
+{
+    cout << "Array of size " << arr.size() << ": ";
+    for (T value : arr)
+        cout << value << " ";
+    cout << endl;
+}
+
+// Array reductions: max, min, sum and argmax. reduction_kernels<T>() is
+// explicitly specialised for int32_t, int64_t, float and double with AVX2
+// kernels, picked by CPU feature at runtime (or directly, when the file is
+// compiled with -mavx2); any other T gets the portable loops. Semantics:
+//   - a NaN anywhere makes max and min NaN, and argmax returns the first NaN;
+//     otherwise argmax returns the first index of the maximum
+//   - int32 sums accumulate in int64 and float sums in double
+//   - integer sums wrap modulo 2^64 on overflow (computed in uint64_t), the
+//     same on the scalar and AVX2 paths
+//   - max, min and argmax of an empty range throw invalid_argument
+template <typename T>
+struct sum_type
+{
+    typedef T type;
+};
+template <>
+struct sum_type<int32_t>
+{
+    typedef int64_t type;
+};
+template <>
+struct sum_type<float>
+{
+    typedef double type;
+};
+
+template <typename T>
+bool is_nan_value(T value)
+{
+    if constexpr (is_floating_point<T>::value)
+        return std::isnan(value);
+    else
+        return false;
+}
+
+template <typename T>
+T scalar_max(const T *data, size_t n)
+{
+    T best = data[0];
+    for (size_t i = 0; i < n; i++)
+    {
+        if (is_nan_value(data[i]))
+            return data[i];
+        best = data[i] > best ? data[i] : best;
+    }
+    return best;
+}
+
+template <typename T>
+T scalar_min(const T *data, size_t n)
+{
+    T best = data[0];
+    for (size_t i = 0; i < n; i++)
+    {
+        if (is_nan_value(data[i]))
+            return data[i];
+        best = data[i] < best ? data[i] : best;
+    }
+    return best;
+}
+
+// a + b for sums: wraps through the unsigned type for integers, so that
+// overflow is defined
+template <typename S>
+S sum_add(S a, S b)
+{
+    if constexpr (is_integral<S>::value)
+    {
+        typedef typename make_unsigned<S>::type U;
+        return S(U(a) + U(b));
+    }
+    else
+        return a + b;
+}
+
+template <typename T>
+typename sum_type<T>::type scalar_sum(const T *data, size_t n)
+{
+    typedef typename sum_type<T>::type S;
+    S total = 0;
+    for (size_t i = 0; i < n; i++)
+        total = sum_add(total, S(data[i]));
+    return total;
+}
+
+template <typename T>
+size_t scalar_argmax(const T *data, size_t n)
+{
+    size_t best = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (is_nan_value(data[i]))
+            return i;
+        if (data[i] > data[best])
+            best = i;
+    }
+    return best;
+}
+
+template <typename T>
+struct ReductionKernels
+{
+    T (*max)(const T *, size_t);
+    T (*min)(const T *, size_t);
+    typename sum_type<T>::type (*sum)(const T *, size_t);
+    size_t (*argmax)(const T *, size_t);
+    const char *name;
+};
+
+#ifdef HAVE_X86_SIMD
+// Per-type AVX2 operations, so one kernel template serves all four types
+template <typename T>
+struct Avx2Ops;
+
+template <>
+struct Avx2Ops<int32_t>
+{
+    typedef __m256i Vec;
+    typedef __m256i SumVec;
+    static const int lanes = 8;
+    __attribute__((target("avx2"))) static Vec load(const int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) { return _mm256_min_epi32(a, b); }
+    __attribute__((target("avx2"))) static Vec nan_lanes(Vec) { return _mm256_setzero_si256(); }
+    __attribute__((target("avx2"))) static bool any(Vec mask) { return !_mm256_testz_si256(mask, mask); }
+    __attribute__((target("avx2"))) static Vec either(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+    __attribute__((target("avx2"))) static SumVec sum_zero() { return _mm256_setzero_si256(); }
+    // Sign-extends each half to int64 before adding
+    __attribute__((target("avx2"))) static void accumulate(SumVec &low, SumVec &high, Vec v)
+    {
+        low = _mm256_add_epi64(low, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        high = _mm256_add_epi64(high, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    __attribute__((target("avx2"))) static int64_t total(SumVec a, SumVec b)
+    {
+        alignas(32) int64_t parts[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(parts), _mm256_add_epi64(a, b));
+        return int64_t(uint64_t(parts[0]) + uint64_t(parts[1]) + uint64_t(parts[2]) + uint64_t(parts[3]));
+    }
+};
+
+template <>
+struct Avx2Ops<int64_t>
+{
+    typedef __m256i Vec;
+    typedef __m256i SumVec;
+    static const int lanes = 4;
+    __attribute__((target("avx2"))) static Vec load(const int64_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    // No 64-bit max/min before AVX-512: compare and blend
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+    __attribute__((target("avx2"))) static Vec nan_lanes(Vec) { return _mm256_setzero_si256(); }
+    __attribute__((target("avx2"))) static bool any(Vec mask) { return !_mm256_testz_si256(mask, mask); }
+    __attribute__((target("avx2"))) static Vec either(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+    __attribute__((target("avx2"))) static SumVec sum_zero() { return _mm256_setzero_si256(); }
+    __attribute__((target("avx2"))) static void accumulate(SumVec &even, SumVec &, Vec v) { even = _mm256_add_epi64(even, v); }
+    __attribute__((target("avx2"))) static int64_t total(SumVec a, SumVec b)
+    {
+        alignas(32) int64_t parts[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(parts), _mm256_add_epi64(a, b));
+        return int64_t(uint64_t(parts[0]) + uint64_t(parts[1]) + uint64_t(parts[2]) + uint64_t(parts[3]));
+    }
+};
+
+template <>
+struct Avx2Ops<float>
+{
+    typedef __m256 Vec;
+    typedef __m256d SumVec;
+    static const int lanes = 8;
+    __attribute__((target("avx2"))) static Vec load(const float *p) { return _mm256_loadu_ps(p); }
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+    __attribute__((target("avx2"))) static Vec nan_lanes(Vec v) { return _mm256_cmp_ps(v, v, _CMP_UNORD_Q); }
+    __attribute__((target("avx2"))) static bool any(Vec mask) { return _mm256_movemask_ps(mask) != 0; }
+    __attribute__((target("avx2"))) static Vec either(Vec a, Vec b) { return _mm256_or_ps(a, b); }
+    __attribute__((target("avx2"))) static SumVec sum_zero() { return _mm256_setzero_pd(); }
+    // Widens each half to double before adding
+    __attribute__((target("avx2"))) static void accumulate(SumVec &low, SumVec &high, Vec v)
+    {
+        low = _mm256_add_pd(low, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        high = _mm256_add_pd(high, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+    __attribute__((target("avx2"))) static double total(SumVec a, SumVec b)
+    {
+        alignas(32) double parts[4];
+        _mm256_store_pd(parts, _mm256_add_pd(a, b));
+        return (parts[0] + parts[1]) + (parts[2] + parts[3]);
+    }
+};
+
+template <>
+struct Avx2Ops<double>
+{
+    typedef __m256d Vec;
+    typedef __m256d SumVec;
+    static const int lanes = 4;
+    __attribute__((target("avx2"))) static Vec load(const double *p) { return _mm256_loadu_pd(p); }
+    __attribute__((target("avx2"))) static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+    __attribute__((target("avx2"))) static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+    __attribute__((target("avx2"))) static Vec nan_lanes(Vec v) { return _mm256_cmp_pd(v, v, _CMP_UNORD_Q); }
+    __attribute__((target("avx2"))) static bool any(Vec mask) { return _mm256_movemask_pd(mask) != 0; }
+    __attribute__((target("avx2"))) static Vec either(Vec a, Vec b) { return _mm256_or_pd(a, b); }
+    __attribute__((target("avx2"))) static SumVec sum_zero() { return _mm256_setzero_pd(); }
+    __attribute__((target("avx2"))) static void accumulate(SumVec &even, SumVec &, Vec v) { even = _mm256_add_pd(even, v); }
+    __attribute__((target("avx2"))) static double total(SumVec a, SumVec b)
+    {
+        alignas(32) double parts[4];
+        _mm256_store_pd(parts, _mm256_add_pd(a, b));
+        return (parts[0] + parts[1]) + (parts[2] + parts[3]);
+    }
+};
+
+// Two accumulators per loop so consecutive vectors do not wait on each
+// other; a NaN lane is remembered in a mask and reported after the loop
+template <typename T, bool Max>
+__attribute__((target("avx2"))) T avx2_extreme(const T *data, size_t n)
+{
+    typedef Avx2Ops<T> Ops;
+    const size_t step = 2 * Ops::lanes;
+    if (n < step)
+        return Max ? scalar_max(data, n) : scalar_min(data, n);
+    typename Ops::Vec first = Ops::load(data), second = Ops::load(data + Ops::lanes);
+    typename Ops::Vec nan = Ops::either(Ops::nan_lanes(first), Ops::nan_lanes(second));
+    size_t i = step;
+    for (; i + step <= n; i += step)
+    {
+        typename Ops::Vec a = Ops::load(data + i), b = Ops::load(data + i + Ops::lanes);
+        first = Max ? Ops::max(first, a) : Ops::min(first, a);
+        second = Max ? Ops::max(second, b) : Ops::min(second, b);
+        if (is_floating_point<T>::value)
+            nan = Ops::either(nan, Ops::either(Ops::nan_lanes(a), Ops::nan_lanes(b)));
+    }
+    if (is_floating_point<T>::value && Ops::any(nan))
+        return numeric_limits<T>::quiet_NaN();
+    alignas(32) T lanes[2 * Ops::lanes];
+    memcpy(lanes, &first, sizeof(first));
+    memcpy(lanes + Ops::lanes, &second, sizeof(second));
+    T best = Max ? scalar_max(lanes, step) : scalar_min(lanes, step);
+    if (i < n)
+    {
+        T tail = Max ? scalar_max(data + i, n - i) : scalar_min(data + i, n - i);
+        if (is_nan_value(tail))
+            return tail;
+        best = Max ? (tail > best ? tail : best) : (tail < best ? tail : best);
+    }
+    return best;
+}
+
+template <typename T>
+__attribute__((target("avx2"))) T avx2_max(const T *data, size_t n) { return avx2_extreme<T, true>(data, n); }
+
+template <typename T>
+__attribute__((target("avx2"))) T avx2_min(const T *data, size_t n) { return avx2_extreme<T, false>(data, n); }
+
+template <typename T>
+__attribute__((target("avx2"))) typename sum_type<T>::type avx2_sum(const T *data, size_t n)
+{
+    typedef Avx2Ops<T> Ops;
+    typename Ops::SumVec first = Ops::sum_zero(), second = Ops::sum_zero();
+    typename Ops::SumVec third = Ops::sum_zero(), fourth = Ops::sum_zero();
+    size_t i = 0;
+    for (; i + 2 * Ops::lanes <= n; i += 2 * Ops::lanes)
+    {
+        Ops::accumulate(first, second, Ops::load(data + i));
+        Ops::accumulate(third, fourth, Ops::load(data + i + Ops::lanes));
+    }
+    typename sum_type<T>::type total = sum_add(Ops::total(first, third), Ops::total(second, fourth));
+    return sum_add(total, scalar_sum(data + i, n - i));
+}
+
+// One pass in blocks that stay in L1: the vector max of each block, and a
+// rescan of the block only when it beats the best so far
+template <typename T>
+__attribute__((target("avx2"))) size_t avx2_argmax(const T *data, size_t n)
+{
+    const size_t block = 4096;
+    size_t bestIndex = 0;
+    T best = data[0];
+    for (size_t start = 0; start < n; start += block)
+    {
+        size_t length = min(block, n - start);
+        T blockMax = avx2_max(data + start, length);
+        if (is_nan_value(blockMax))
+            return start + scalar_argmax(data + start, length);
+        if (blockMax > best || start == 0)
+        {
+            best = blockMax;
+            bestIndex = start + size_t(find(data + start, data + start + length, blockMax) - (data + start));
+        }
+    }
+    return bestIndex;
+}
+#endif
+
+template <typename T>
+ReductionKernels<T> select_reduction_kernels()
+{
+    return {scalar_max<T>, scalar_min<T>, scalar_sum<T>, scalar_argmax<T>, "scalar"};
+}
+
+#ifdef HAVE_X86_SIMD
+template <typename T>
+ReductionKernels<T> select_avx2_or_scalar()
+{
+#ifndef __AVX2__
+    if (!__builtin_cpu_supports("avx2"))
+        return {scalar_max<T>, scalar_min<T>, scalar_sum<T>, scalar_argmax<T>, "scalar"};
+#endif
+    return {avx2_max<T>, avx2_min<T>, avx2_sum<T>, avx2_argmax<T>, "AVX2"};
+}
+
+template <>
+ReductionKernels<int32_t> select_reduction_kernels<int32_t>() { return select_avx2_or_scalar<int32_t>(); }
+template <>
+ReductionKernels<int64_t> select_reduction_kernels<int64_t>() { return select_avx2_or_scalar<int64_t>(); }
+template <>
+ReductionKernels<float> select_reduction_kernels<float>() { return select_avx2_or_scalar<float>(); }
+template <>
+ReductionKernels<double> select_reduction_kernels<double>() { return select_avx2_or_scalar<double>(); }
+#endif
+
+template <typename T>
+const ReductionKernels<T> &reduction_kernels()
+{
+    static const ReductionKernels<T> kernels = select_reduction_kernels<T>();
+    return kernels;
+}
+
+template <typename T>
+T reduce_max(const T *data, size_t n)
+{
+    if (n == 0)
+        throw invalid_argument("reduce_max of an empty range");
+    return reduction_kernels<T>().max(data, n);
+}
+
+template <typename T>
+T reduce_min(const T *data, size_t n)
+{
+    if (n == 0)
+        throw invalid_argument("reduce_min of an empty range");
+    return reduction_kernels<T>().min(data, n);
+}
+
+template <typename T>
+typename sum_type<T>::type reduce_sum(const T *data, size_t n)
+{
+    return reduction_kernels<T>().sum(data, n);
+}
+
+template <typename T>
+size_t reduce_argmax(const T *data, size_t n)
+{
+    if (n == 0)
+        throw invalid_argument("reduce_argmax of an empty range");
+    return reduction_kernels<T>().argmax(data, n);
+}
+
+// The same for built-in arrays, like print_array
+template <typename T, int size>
+T reduce_max(T (&arr)[size]) { return reduce_max(arr, size_t(size)); }
+
+template <typename T, int size>
+typename sum_type<T>::type reduce_sum(T (&arr)[size]) { return reduce_sum(arr, size_t(size)); }
+
+// Benchmarks: build with optimizations for meaningful numbers, e.g.
+//   g++ -std=c++17 -O2 -o 09-template-metaprogramming 09-template-metaprogramming.cpp && ./09-template-metaprogramming --bench
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Computes C(n, k) at runtime by the multiplicative formula, for comparison
+uint64_t binomial_runtime(unsigned n, unsigned k)
+{
+    k = min(k, n - k);
+    uint128_t result = 1;
+    for (unsigned i = 1; i <= k; i++)
+        result = result * (n - k + i) / i;
+    return uint64_t(result);
+}
+
+template <typename Lookup>
+void time_lookups(const string &name, const vector<uint8_t> &ns, const vector<uint8_t> &ks, Lookup lookup)
+{
+    auto start = chrono::steady_clock::now();
+    uint64_t checksum = 0;
+    for (size_t i = 0; i < ns.size(); i++)
+        checksum += lookup(ns[i], ks[i]);
+    double ms = elapsedMs(start);
+    cout << "  " << name << ": " << ms * 1e6 / ns.size() << " ns per value (checksum " << checksum << ")" << endl;
+}
+
+void benchmarkTables(int count)
+{
+    vector<uint8_t> ns(count), ks(count);
+    mt19937 rng(3);
+    for (int i = 0; i < count; i++)
+    {
+        ns[i] = uint8_t(rng() % 13);
+        ks[i] = uint8_t(rng() % (ns[i] + 1));
+    }
+    static constexpr auto enumFactorials = enum_factorial_table(make_index_sequence<13>());
+
+    cout << "=== Lookup tables, " << count << " random n ===" << endl;
+    time_lookups("factorial, constexpr_factorial(n) at runtime", ns, ks, [](unsigned n, unsigned)
+                 { return uint64_t(constexpr_factorial(int(n))); });
+    time_lookups("factorial, table of factorial<I>::value", ns, ks, [](unsigned n, unsigned)
+                 { return enumFactorials[n]; });
+    time_lookups("factorial, factorial_table", ns, ks, [](unsigned n, unsigned)
+                 { return factorials[n]; });
+
+    for (int i = 0; i < count; i++)
+    {
+        ns[i] = uint8_t(rng() % 68);
+        ks[i] = uint8_t(rng() % (ns[i] + 1));
+    }
+    time_lookups("C(n, k) for n < 68, multiplicative formula", ns, ks, [](unsigned n, unsigned k)
+                 { return binomial_runtime(n, k); });
+    time_lookups("C(n, k) for n < 68, binomial_table", ns, ks, [](unsigned n, unsigned k)
+                 { return binomials[n][k]; });
+}
+
+// The code expression templates replace: every operator returns a new vector
+namespace naive
+{
+    vector<double> operator+(const vector<double> &a, const vector<double> &b)
+    {
+        vector<double> result(a.size());
+        for (size_t i = 0; i < a.size(); i++)
+            result[i] = a[i] + b[i];
+        return result;
+    }
+
+    vector<double> operator*(const vector<double> &a, const vector<double> &b)
+    {
+        vector<double> result(a.size());
+        for (size_t i = 0; i < a.size(); i++)
+            result[i] = a[i] * b[i];
+        return result;
+    }
+
+    vector<double> operator-(const vector<double> &a, const vector<double> &b)
+    {
+        vector<double> result(a.size());
+        for (size_t i = 0; i < a.size(); i++)
+            result[i] = a[i] - b[i];
+        return result;
+    }
+}
+
+// The hand-written loops are kept out of line: inlined, the optimizer sees
+// every round compute the same values and drops all but one of them
+__attribute__((noinline)) void hand_written_short(const double *a, const double *b, const double *c, double *out, int n)
+{
+    for (int i = 0; i < n; i++)
+        out[i] = a[i] * b[i] + c[i];
+}
+
+__attribute__((noinline)) void hand_written_long(const double *a, const double *b, const double *c, const double *d,
+                                                 double *out, int n)
+{
+    for (int i = 0; i < n; i++)
+        out[i] = a[i] * b[i] + c[i] * d[i] - (a[i] + d[i]) * c[i];
+}
+
+void benchmarkExpressions(int n)
+{
+    const int rounds = 10;
+    vector<double> a(n), b(n), c(n), d(n);
+    mt19937 rng(5);
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (int i = 0; i < n; i++)
+    {
+        a[i] = dist(rng);
+        b[i] = dist(rng);
+        c[i] = dist(rng);
+        d[i] = dist(rng);
+    }
+    Array<double> ea(n), eb(n), ec(n), ed(n), result(n);
+    copy(a.begin(), a.end(), ea.begin());
+    copy(b.begin(), b.end(), eb.begin());
+    copy(c.begin(), c.end(), ec.begin());
+    copy(d.begin(), d.end(), ed.begin());
+    vector<double> loop(n), naiveResult;
+
+    cout << "=== Array expressions on " << n << " doubles (ms per evaluation) ===" << endl;
+    auto report = [&](const string &name, double naiveMs, double exprMs, double loopMs)
+    {
+        bool ok = equal(loop.begin(), loop.end(), naiveResult.begin()) &&
+                  equal(loop.begin(), loop.end(), result.begin());
+        cout << "  " << name << ": vector operators " << naiveMs / rounds << ", expression templates "
+             << exprMs / rounds << ", hand-written loop " << loopMs / rounds << (ok ? "" : " (MISMATCH)") << endl;
+    };
+
+    using naive::operator+;
+    using naive::operator*;
+    using naive::operator-;
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        naiveResult = a * b + c;
+    double naiveMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        result = ea * eb + ec;
+    double exprMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        hand_written_short(a.data(), b.data(), c.data(), loop.data(), n);
+    report("a * b + c", naiveMs, exprMs, elapsedMs(start));
+
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        naiveResult = a * b + c * d - (a + d) * c;
+    naiveMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        result = ea * eb + ec * ed - (ea + ed) * ec;
+    exprMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        hand_written_long(a.data(), b.data(), c.data(), d.data(), loop.data(), n);
+    report("a * b + c * d - (a + d) * c", naiveMs, exprMs, elapsedMs(start));
+}
+
+// Branchy one-at-a-time loops like findMax, against std algorithms and the kernels
+template <typename T>
+void benchmarkReductionsFor(const string &typeName, size_t n)
+{
+    vector<T> data(n);
+    uint64_t state = 88172645463325252ull;
+    for (T &value : data)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Integers stay within int32 range, so even 1G int64 values sum without overflow
+        value = is_floating_point<T>::value ? T(double(state >> 11) / double(1ull << 53)) : T(int64_t(state) >> 32);
+    }
+    double gigabytes = double(n) * sizeof(T) / 1e9;
+    auto rate = [&](double ms)
+    { return gigabytes / (ms / 1000); };
+
+    cout << "  " << typeName << " (" << reduction_kernels<T>().name << "), GB/s:" << endl;
+    auto start = chrono::steady_clock::now();
+    T loopMax = data[0];
+    for (size_t i = 1; i < n; i++)
+        if (data[i] > loopMax)
+            loopMax = data[i];
+    double loopMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    T stdMax = *max_element(data.begin(), data.end());
+    double stdMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    T kernelMax = reduce_max(data.data(), n);
+    double kernelMs = elapsedMs(start);
+    cout << "    max: loop " << rate(loopMs) << ", std::max_element " << rate(stdMs) << ", reduce_max "
+         << rate(kernelMs) << (loopMax == stdMax && stdMax == kernelMax ? "" : " (MISMATCH)") << endl;
+
+    start = chrono::steady_clock::now();
+    typename sum_type<T>::type loopSum = 0;
+    for (size_t i = 0; i < n; i++)
+        loopSum += data[i];
+    loopMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    typename sum_type<T>::type kernelSum = reduce_sum(data.data(), n);
+    kernelMs = elapsedMs(start);
+    // Float sums differ in the last bits with the order of additions
+    bool sumOk = is_floating_point<T>::value ? fabs(double(loopSum - kernelSum)) <= 1e-9 * fabs(double(loopSum)) + 1e-6
+                                             : loopSum == kernelSum;
+    cout << "    sum: loop " << rate(loopMs) << ", reduce_sum " << rate(kernelMs) << (sumOk ? "" : " (MISMATCH)") << endl;
+
+    start = chrono::steady_clock::now();
+    size_t stdIndex = size_t(max_element(data.begin(), data.end()) - data.begin());
+    stdMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    size_t kernelIndex = reduce_argmax(data.data(), n);
+    kernelMs = elapsedMs(start);
+    cout << "    argmax: std::max_element " << rate(stdMs) << ", reduce_argmax " << rate(kernelMs)
+         << (stdIndex == kernelIndex ? "" : " (MISMATCH)") << endl;
+}
+
+void benchmarkReductions(size_t n)
+{
+    cout << "=== Reductions over " << n << " elements ===" << endl;
+    benchmarkReductionsFor<int32_t>("int32", n);
+    benchmarkReductionsFor<int64_t>("int64", n);
+    benchmarkReductionsFor<float>("float", n);
+    benchmarkReductionsFor<double>("double", n);
+}
+
+// Usage: --bench [name] [n], where name is one of: all, tables, expressions, reductions
+int runBenchmarks(const string &which, int n)
+{
+    bool all = which == "all";
+    bool known = false;
+    if (all || which == "tables")
+    {
+        benchmarkTables(n ? n : 100000000);
+        known = true;
+    }
+    if (all || which == "expressions")
+    {
+        benchmarkExpressions(n ? n : 10000000);
+        known = true;
+    }
+    if (all || which == "reductions")
+    {
+        // 1G elements needs 4-8 GB per array; ask for it with --bench reductions 1000000000
+        benchmarkReductions(n ? size_t(n) : 250000000);
+        known = true;
+    }
+    if (!known)
+    {
+        cout << "Unknown benchmark: " << which << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--bench")
+        return runBenchmarks(argc > 2 ? argv[2] : "all", argc > 3 ? atoi(argv[3]) : 0);
+
     cout << "=== Template Metaprogramming ===" << endl;
 
     // These values are calculated at compile time!
@@ -123,6 +1174,16 @@ int main()
     cout << "constexpr_factorial(5) = " << constexpr_factorial(5) << endl;
     cout << "constexpr_power_of_2(8) = " << constexpr_power_of_2(8) << endl;
 
+    cout << "\n=== constexpr lookup tables ===" << endl;
+    cout << "factorials[20] = " << factorials[20] << endl;
+    cout << "factorials_wide[34] = " << to_string_u128(factorials_wide[34]) << endl;
+    cout << "powers_of_2[63] = " << powers_of_2[63] << endl;
+    cout << "fibonaccis[93] = " << fibonaccis[93] << endl;
+    cout << "fibonaccis_wide[186] = " << to_string_u128(fibonaccis_wide[186]) << endl;
+    cout << "binomials[10][3] = " << binomials[10][3] << endl;
+    int n = 7; // a runtime index is fine; the table was built by the compiler
+    cout << "squares[" << n << "] = " << squares[n] << endl;
+
     cout << "\n=== Template Functions ===" << endl;
     cout << "max(10, 20) = " << max_value(10, 20) << endl;
     cout << "max(3.14, 2.71) = " << max_value(3.14, 2.71) << endl;
@@ -133,6 +1194,18 @@ int main()
 
     print_array(int_arr);
     print_array(double_arr);
+    cout << "reduce_max(int_arr) = " << reduce_max(int_arr) << ", reduce_sum(double_arr) = " << reduce_sum(double_arr) << endl;
+    double with_nan[] = {1.0, NAN, 3.0};
+    cout << "reduce_max with a NaN = " << reduce_max(with_nan, 3) << ", reduce_argmax = " << reduce_argmax(with_nan, 3) << endl;
+
+    cout << "\n=== Expression templates ===" << endl;
+    double xs[] = {1.0, 2.0, 3.0, 4.0};
+    double ys[] = {10.0, 20.0, 30.0, 40.0};
+    Array<double, 4> fixed = view(xs) * view(ys) + 0.5; // extent checked at compile time
+    print_array(fixed);
+    Array<double> dynamic(xs);
+    dynamic = dynamic * 2.0 - view(ys) / 10.0; // evaluated in one loop, no temporaries
+    print_array(dynamic);
 
     return 0;
 }
\ No newline at end of file
@@ -2,6 +2,16 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 using namespace std;
 
 // Regular function definitions
@@ -33,6 +43,38 @@ int factorial(int n)
     return result;
 }
 
+// int overflows past 12!, so bigger factorials are kept as groups of nine
+// decimal digits (least significant first) and multiplied by each factor in
+// turn. advanced/05-recursion.cpp has a much faster big-integer version.
+string bigFactorial(int n)
+{
+    const unsigned long long base = 1000000000;
+    vector<unsigned> groups = {1};
+    for (int i = 2; i <= n; i++)
+    {
+        unsigned long long carry = 0;
+        for (unsigned &group : groups)
+        {
+            carry += (unsigned long long)group * i;
+            group = carry % base;
+            carry /= base;
+        }
+        while (carry)
+        {
+            groups.push_back(carry % base);
+            carry /= base;
+        }
+    }
+
+    string result = to_string(groups.back());
+    for (int k = (int)groups.size() - 2; k >= 0; k--)
+    {
+        string group = to_string(groups[k]);
+        result += string(9 - group.size(), '0') + group;
+    }
+    return result;
+}
+
 double calculateArea(double length, double width, string shape)
 {
     if (shape == "rectangle")
@@ -50,38 +92,215 @@ double calculateArea(double length, double width, string shape)
     return 0.0;
 }
 
-int findMax(vector<int> arr)
+// Branch-free max/min (std::max, std::min) and a 64-bit sum let the compiler
+// vectorize these loops; explicit SIMD reductions are in
+// advanced/09-template-metaprogramming.cpp
+int findMax(const int *arr, size_t n)
 {
+    if (n == 0)
+        throw invalid_argument("findMax of an empty array");
     int max = arr[0];
-    for (int i = 1; i < arr.size(); i++)
+    for (size_t i = 1; i < n; i++)
     {
-        if (arr[i] > max)
-        {
-            max = arr[i];
-        }
+        max = std::max(max, arr[i]);
     }
     return max;
 }
+int findMax(const vector<int> &arr)
+{
+    return findMax(arr.data(), arr.size());
+}
 
-void calculateStats(vector<int> arr)
+// Count, sum, min, max, mean and variance in one pass over the data, fed in
+// chunks of any size. Each block of STATS_BLOCK values is summarised while
+// it is in cache (one vectorizable loop for sum/min/max, one for the squared
+// deviations from the block mean) and then combined with the running totals
+// by the pairwise update of Chan et al. The same update merges two
+// accumulators, so partial results from separate chunks or threads add up to
+// the result of one pass over everything.
+const size_t STATS_BLOCK = 2048;
+
+struct RunningStats
 {
-    int sum = 0, max = arr[0], min = arr[0];
-    for (int num : arr)
+    long long count = 0;
+    long long sum = 0;
+    int min = INT_MAX;
+    int max = INT_MIN;
+    double mean = 0.0;
+    double m2 = 0.0; // sum of squared deviations from the mean
+
+    void add(int value)
     {
-        sum += num;
-        if (num > max)
-            max = num;
-        if (num < min)
-            min = num;
+        add(&value, 1);
+    }
+
+    void add(const int *data, size_t n)
+    {
+        for (size_t start = 0; start < n; start += STATS_BLOCK)
+            addBlock(data + start, std::min(STATS_BLOCK, n - start));
+    }
+
+    void merge(const RunningStats &other)
+    {
+        if (other.count == 0)
+            return;
+        if (count == 0)
+        {
+            *this = other;
+            return;
+        }
+        long long total = count + other.count;
+        double delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * ((double)count * other.count / total);
+        count = total;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
     }
-    double average = (double)sum / arr.size();
+
+    double variance() const // population variance
+    {
+        return count ? m2 / count : 0.0;
+    }
+
+    double sampleVariance() const
+    {
+        return count > 1 ? m2 / (count - 1) : 0.0;
+    }
+
+    double standardDeviation() const
+    {
+        return sqrt(variance());
+    }
+
+private:
+    void addBlock(const int *data, size_t n)
+    {
+        RunningStats block;
+        block.count = n;
+        for (size_t i = 0; i < n; i++)
+        {
+            block.sum += data[i];
+            block.min = std::min(block.min, data[i]);
+            block.max = std::max(block.max, data[i]);
+        }
+        block.mean = (double)block.sum / n;
+        // Four partial sums, so the additions do not wait on each other
+        double partial[4] = {0.0, 0.0, 0.0, 0.0};
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            for (int lane = 0; lane < 4; lane++)
+            {
+                double deviation = data[i + lane] - block.mean;
+                partial[lane] += deviation * deviation;
+            }
+        for (; i < n; i++)
+            partial[0] += (data[i] - block.mean) * (data[i] - block.mean);
+        block.m2 = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+        merge(block);
+    }
+};
+
+// Reads raw native-endian ints from a stream a chunk at a time, so the input
+// can be far larger than memory
+const size_t STATS_CHUNK = 1 << 16;
+
+RunningStats statsFromStream(istream &in)
+{
+    RunningStats stats;
+    vector<int> buffer(STATS_CHUNK);
+    while (in)
+    {
+        in.read(reinterpret_cast<char *>(buffer.data()), buffer.size() * sizeof(int));
+        stats.add(buffer.data(), in.gcount() / sizeof(int));
+    }
+    return stats;
+}
+
+bool statsFromFile(const string &path, RunningStats &stats)
+{
+    ifstream file(path, ios::binary);
+    if (!file)
+        return false;
+    stats = statsFromStream(file);
+    return true;
+}
+
+// Runs fn(chunk, begin, end) for `threads` contiguous chunks of [0, n), one
+// per thread, with chunk 0 on the calling thread. A copy of the helper in
+// advanced/08-function-pointers.cpp, since each script builds on its own.
+template <typename Fn>
+void forEachChunk(size_t n, unsigned threads, Fn fn)
+{
+    vector<thread> workers;
+    for (unsigned t = 1; t < threads; t++)
+        workers.emplace_back(fn, t, n * t / threads, n * (t + 1) / threads);
+    fn(0u, size_t(0), n / threads);
+    for (thread &worker : workers)
+        worker.join();
+}
+
+// Each thread writes only its own partial, padded to a cache line so that
+// neighbouring threads never write to the same line (false sharing)
+const size_t CACHE_LINE = 64;
+const size_t PARALLEL_MIN_CHUNK = 1 << 16;
+
+template <typename T>
+struct alignas(CACHE_LINE) Padded
+{
+    T value;
+};
+
+unsigned usefulThreads(size_t n, unsigned threads)
+{
+    return std::max(1u, std::min(threads, unsigned(std::min<size_t>(n / PARALLEL_MIN_CHUNK + 1, UINT_MAX))));
+}
+
+// Partials are combined in chunk order, so the result depends only on the
+// input and the thread count, not on which thread finishes first
+int parallelFindMax(const int *arr, size_t n, unsigned threads = thread::hardware_concurrency())
+{
+    if (n == 0)
+        throw invalid_argument("parallelFindMax of an empty array");
+    threads = usefulThreads(n, threads);
+    vector<Padded<int>> partials(threads);
+    forEachChunk(n, threads, [&](unsigned chunk, size_t begin, size_t end)
+                 { partials[chunk].value = findMax(arr + begin, end - begin); });
+    int max = partials[0].value;
+    for (const Padded<int> &partial : partials)
+        max = std::max(max, partial.value);
+    return max;
+}
+
+RunningStats parallelStats(const int *arr, size_t n, unsigned threads = thread::hardware_concurrency())
+{
+    threads = usefulThreads(n, threads);
+    vector<Padded<RunningStats>> partials(threads);
+    forEachChunk(n, threads, [&](unsigned chunk, size_t begin, size_t end)
+                 { partials[chunk].value.add(arr + begin, end - begin); });
+    RunningStats stats;
+    for (const Padded<RunningStats> &partial : partials)
+        stats.merge(partial.value);
+    return stats;
+}
+
+void printStats(const RunningStats &stats)
+{
+    cout << "Count: " << stats.count << ", Sum: " << stats.sum << ", Average: " << stats.mean << endl;
+    cout << "Max: " << stats.max << ", Min: " << stats.min
+         << ", Std dev: " << stats.standardDeviation() << endl;
+}
+
+void calculateStats(const vector<int> &arr)
+{
+    RunningStats stats = parallelStats(arr.data(), arr.size());
 
     cout << "Statistics for array: ";
     for (int num : arr)
         cout << num << " ";
     cout << endl;
-    cout << "Sum: " << sum << ", Average: " << average << endl;
-    cout << "Max: " << max << ", Min: " << min << endl;
+    printStats(stats);
 }
 
 // Advanced example with structs
@@ -133,8 +352,285 @@ string findTopStudent(const vector<Student> &students)
     return topStudent;
 }
 
-int main()
+// The same data stored by column: all names together, every student's grades
+// back to back in one array (student i owns grades[offsets[i]] up to
+// grades[offsets[i + 1]]), and the GPAs together. Computing GPAs then reads
+// two arrays front to back instead of following one heap pointer per student.
+struct StudentTable
 {
+    vector<string> names;
+    vector<int> grades;
+    vector<size_t> offsets = {0};
+    vector<double> gpas;
+
+    size_t size() const
+    {
+        return names.size();
+    }
+
+    void addStudent(const string &name, const vector<int> &studentGrades)
+    {
+        names.push_back(name);
+        grades.insert(grades.end(), studentGrades.begin(), studentGrades.end());
+        offsets.push_back(grades.size());
+        gpas.push_back(0.0);
+    }
+
+    // One pass over every student, split across threads by student
+    void calculateGPAs(unsigned threads = thread::hardware_concurrency())
+    {
+        const int *allGrades = grades.data();
+        const size_t *bounds = offsets.data();
+        double *out = gpas.data();
+        forEachChunk(size(), usefulThreads(size(), threads), [=](unsigned, size_t begin, size_t end)
+                     {
+                         for (size_t i = begin; i < end; i++)
+                         {
+                             int sum = 0;
+                             for (size_t g = bounds[i]; g < bounds[i + 1]; g++)
+                                 sum += allGrades[g];
+                             size_t count = bounds[i + 1] - bounds[i];
+                             out[i] = count ? (double)sum / count : 0.0;
+                         } });
+    }
+
+    string topStudent() const
+    {
+        if (gpas.empty())
+            return "No students";
+        return names[max_element(gpas.begin(), gpas.end()) - gpas.begin()];
+    }
+};
+
+void processStudents(StudentTable &table)
+{
+    cout << "Processing student table..." << endl;
+    table.calculateGPAs();
+    for (size_t i = 0; i < table.size(); i++)
+        cout << "Student: " << table.names[i] << ", GPA: " << table.gpas[i] << endl;
+}
+
+// Benchmarks: build with optimizations for meaningful numbers, e.g.
+//   g++ -std=c++17 -O2 -o 08-functions 08-functions.cpp && ./08-functions --bench
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Textbook versions: a copy of the input and two passes, and Welford's
+// update one element at a time (a division per element, nothing to vectorize)
+__attribute__((noinline)) double twoPassVariance(vector<int> arr)
+{
+    long long sum = 0;
+    for (int num : arr)
+        sum += num;
+    double mean = (double)sum / arr.size(), m2 = 0.0;
+    for (int num : arr)
+        m2 += (num - mean) * (num - mean);
+    return m2 / arr.size();
+}
+
+__attribute__((noinline)) double welfordVariance(const vector<int> &arr)
+{
+    double mean = 0.0, m2 = 0.0;
+    long long count = 0;
+    for (int num : arr)
+    {
+        count++;
+        double delta = num - mean;
+        mean += delta / count;
+        m2 += delta * (num - mean);
+    }
+    return m2 / count;
+}
+
+void benchmarkStats(int n)
+{
+    cout << "=== Statistics over " << n << " ints ===" << endl;
+    vector<int> data(n);
+    unsigned state = 2463534242u;
+    for (int &value : data)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        value = (int)state;
+    }
+
+    auto start = chrono::steady_clock::now();
+    double twoPass = twoPassVariance(data);
+    double twoPassMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    double welford = welfordVariance(data);
+    double welfordMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    RunningStats stats;
+    stats.add(data.data(), data.size());
+    double blockMs = elapsedMs(start);
+    cout << "  copy + two passes: " << twoPassMs << " ms (variance " << twoPass << ")" << endl;
+    cout << "  per-element Welford: " << welfordMs << " ms (variance " << welford << ")" << endl;
+    cout << "  RunningStats: " << blockMs << " ms (variance " << stats.variance() << ")" << endl;
+
+    const string path = "08-functions-stats.bin";
+    {
+        ofstream file(path, ios::binary);
+        file.write(reinterpret_cast<const char *>(data.data()), data.size() * sizeof(int));
+    }
+    RunningStats fromFile;
+    start = chrono::steady_clock::now();
+    bool opened = statsFromFile(path, fromFile);
+    double fileMs = elapsedMs(start);
+    remove(path.c_str());
+    if (opened)
+        cout << "  RunningStats from a file: " << fileMs << " ms ("
+             << (fromFile.sum == stats.sum && fromFile.count == stats.count ? "matches" : "MISMATCH") << ")" << endl;
+    else
+        cout << "  Could not write " << path << endl;
+}
+
+// Thread counts 1, 2, 4, ... 64, whatever the machine has, to show where
+// scaling stops (memory bandwidth, then running out of cores)
+void benchmarkParallel(size_t n)
+{
+    cout << "=== Parallel findMax / stats over " << n << " ints ("
+         << thread::hardware_concurrency() << " hardware threads) ===" << endl;
+    // One sequential stream, as in benchmarkStats, so every machine reduces the same data
+    vector<int> data(n);
+    unsigned state = 2463534242u;
+    for (int &value : data)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        value = (int)state;
+    }
+
+    double gigabytes = double(n) * sizeof(int) / 1e9;
+    double singleMaxMs = 0, singleStatsMs = 0;
+    int expectedMax = 0;
+    RunningStats expected;
+    for (unsigned threads = 1; threads <= 64; threads *= 2)
+    {
+        auto start = chrono::steady_clock::now();
+        int max = parallelFindMax(data.data(), n, threads);
+        double maxMs = elapsedMs(start);
+        start = chrono::steady_clock::now();
+        RunningStats stats = parallelStats(data.data(), n, threads);
+        double statsMs = elapsedMs(start);
+        if (threads == 1)
+        {
+            singleMaxMs = maxMs;
+            singleStatsMs = statsMs;
+            expectedMax = max;
+            expected = stats;
+        }
+        bool same = max == expectedMax && stats.sum == expected.sum && stats.min == expected.min &&
+                    stats.max == expected.max && fabs(stats.m2 - expected.m2) <= 1e-9 * expected.m2;
+        cout << "  " << threads << " threads: findMax " << maxMs << " ms (" << gigabytes / (maxMs / 1000)
+             << " GB/s, x" << singleMaxMs / maxMs << "), stats " << statsMs << " ms ("
+             << gigabytes / (statsMs / 1000) << " GB/s, x" << singleStatsMs / statsMs << ")"
+             << (same ? "" : " MISMATCH") << endl;
+    }
+}
+
+// vector<Student> against StudentTable: building both, then the GPA pass
+// (without the printing) and picking the top student
+void benchmarkStudents(int n)
+{
+    cout << "=== GPAs of " << n << " students ===" << endl;
+    unsigned state = 2463534242u;
+    auto nextGrade = [&]()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return int(state % 41) + 60;
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<Student> students(n);
+    for (int i = 0; i < n; i++)
+    {
+        students[i].name = "student" + to_string(i);
+        students[i].grades = {nextGrade(), nextGrade(), nextGrade(), nextGrade()};
+    }
+    double buildStructsMs = elapsedMs(start);
+    start = chrono::steady_clock::now();
+    StudentTable table;
+    table.names.reserve(n);
+    table.grades.reserve(size_t(n) * 4);
+    table.offsets.reserve(size_t(n) + 1);
+    table.gpas.reserve(n);
+    for (const Student &student : students)
+        table.addStudent(student.name, student.grades);
+    double buildTableMs = elapsedMs(start);
+
+    start = chrono::steady_clock::now();
+    for (Student &student : students)
+        student.gpa = calculateGPA(student.grades);
+    string structsTop = findTopStudent(students);
+    double structsMs = elapsedMs(start);
+    double structsChecksum = 0;
+    for (const Student &student : students)
+        structsChecksum += student.gpa;
+
+    cout << "  build: vector<Student> " << buildStructsMs << " ms, StudentTable (from it) " << buildTableMs << " ms"
+         << endl;
+    cout << "  vector<Student>: " << structsMs << " ms (top " << structsTop << ", checksum " << structsChecksum << ")"
+         << endl;
+    vector<unsigned> threadCounts = {1};
+    if (thread::hardware_concurrency() > 1)
+        threadCounts.push_back(thread::hardware_concurrency());
+    for (unsigned threads : threadCounts)
+    {
+        start = chrono::steady_clock::now();
+        table.calculateGPAs(threads);
+        string tableTop = table.topStudent();
+        double tableMs = elapsedMs(start);
+        double tableChecksum = 0;
+        for (double gpa : table.gpas)
+            tableChecksum += gpa;
+        cout << "  StudentTable, " << threads << " threads: " << tableMs << " ms (top " << tableTop << ", checksum "
+             << tableChecksum << ")" << (tableTop == structsTop && tableChecksum == structsChecksum ? "" : " MISMATCH")
+             << endl;
+    }
+}
+
+// Usage: --bench [name] [n], where name is one of: all, stats, parallel, students
+int runBenchmarks(const string &which, int n)
+{
+    bool all = which == "all";
+    bool known = false;
+    if (all || which == "stats")
+    {
+        benchmarkStats(n ? n : 100000000);
+        known = true;
+    }
+    if (all || which == "parallel")
+    {
+        // A 4 GB array is --bench parallel 1073741824
+        benchmarkParallel(n ? size_t(n) : 250000000);
+        known = true;
+    }
+    if (all || which == "students")
+    {
+        // 50M students as vector<Student> need about 6 GB; pass 50000000 where that fits
+        benchmarkStudents(n ? n : 5000000);
+        known = true;
+    }
+    if (!known)
+    {
+        cout << "Unknown benchmark: " << which << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--bench")
+        return runBenchmarks(argc > 2 ? argv[2] : "all", argc > 3 ? atoi(argv[3]) : 0);
+
     // Test basic functions
     cout << "=== Basic Functions ===" << endl;
     int input = 9;
@@ -151,15 +647,28 @@ int main()
     cout << "\n=== Complex Functions ===" << endl;
     cout << "Factorial of 5: " << factorial(5) << endl;
     cout << "Factorial of 7: " << factorial(7) << endl;
+    cout << "Factorial of 25: " << bigFactorial(25) << endl;
 
     cout << "Rectangle area (5x3): " << calculateArea(5.0, 3.0, "rectangle") << endl;
     cout << "Triangle area (5x3): " << calculateArea(5.0, 3.0, "triangle") << endl;
     cout << "Circle area (radius=3): " << calculateArea(3.0, 0, "circle") << endl;
 
     vector<int> numbers = {3, 7, 2, 9, 1, 5, 8};
-    cout << "Maximum in array: " << findMax(numbers) << endl;
+    cout << "Maximum in array: " << findMax(numbers) << " (" << parallelFindMax(numbers.data(), numbers.size(), 4)
+         << " with 4 threads)" << endl;
     calculateStats(numbers);
 
+    // The same statistics fed in two chunks, one from a stream of raw ints,
+    // then merged
+    RunningStats firstHalf, secondHalf;
+    firstHalf.add(numbers.data(), 3);
+    stringstream rest;
+    rest.write(reinterpret_cast<const char *>(numbers.data() + 3), (numbers.size() - 3) * sizeof(int));
+    secondHalf = statsFromStream(rest);
+    firstHalf.merge(secondHalf);
+    cout << "Merged from chunks: ";
+    printStats(firstHalf);
+
     // Test advanced example with structs
     cout << "\n=== Advanced Functions with Structs ===" << endl;
     vector<Student> students = {
@@ -170,5 +679,11 @@ int main()
     processStudents(students);
     cout << "Top student: " << findTopStudent(students) << endl;
 
+    StudentTable table;
+    for (const Student &student : students)
+        table.addStudent(student.name, student.grades);
+    processStudents(table);
+    cout << "Top student: " << table.topStudent() << endl;
+
     return 0;
 }
\ No newline at end of file